@@ -34,8 +34,8 @@ BASE_NAME='libjson';   # Base name for the project.
 PROJECT_PATH=$(pwd);   # Root path of the project.
 
 # Dependencies for tests and library (add as needed).
-TEST_DEPENDENCIES='-lfile -lstr';
-LIBRARY_DEPENDENCIES='-lfile -lstr';
+TEST_DEPENDENCIES='-lfile -lstr -lpthread';
+LIBRARY_DEPENDENCIES='-lfile -lstr -lpthread';
 
 # Search paths for library and test code.
 LIBRARY_CODE_SEARCH_PATHS="$PROJECT_PATH/include $PROJECT_PATH/src";
@@ -1,6 +1,89 @@
 #ifndef JSON_H
 #define JSON_H
 
+#include <stdint.h>
+
+/**
+ * The size in bytes of the buffer used to store short strings inline.
+ *
+ * Strings shorter than this size (NUL terminator excluded) are stored inside
+ * the node itself instead of a separate heap allocation.
+ */
+#define JSON_INLINE_STRING_SIZE 16
+
+/**
+ * The default maximum nesting depth of arrays and objects accepted by the decoder.
+ */
+#define JSON_DEFAULT_MAX_DEPTH 1024
+
+/**
+ * Node flag: the key points into the decoded input and is not NUL terminated.
+ *
+ * Its length is stored in key_length.
+ */
+#define JSON_FLAG_KEY_VIEW 0x01
+
+/**
+ * Node flag: the string value points into the decoded input and is not NUL terminated.
+ *
+ * Its length is stored in scalar.view.length.
+ */
+#define JSON_FLAG_VALUE_VIEW 0x02
+
+/**
+ * Node flag: the string value view contains escape sequences.
+ *
+ * The string is materialized on first access through json_string_value() or
+ * json_string_view().
+ */
+#define JSON_FLAG_VALUE_ESCAPED 0x04
+
+/**
+ * Node flag: the number holds an exact 64-bit integer in scalar.integer.value.
+ *
+ * scalar.number still holds the value as a double.
+ */
+#define JSON_FLAG_INTEGER 0x08
+
+/**
+ * Node flag: the exact integer of the number is an uint64_t above INT64_MAX.
+ *
+ * Only set together with JSON_FLAG_INTEGER.
+ */
+#define JSON_FLAG_UNSIGNED 0x10
+
+/**
+ * Decode flag: store unescaped strings and keys as views into the input.
+ *
+ * Strings with escape sequences are resolved on first access, and keys with
+ * escape sequences are copied. The input must outlive the decoded JSON object.
+ */
+#define JSON_DECODE_ZERO_COPY 0x01
+
+/**
+ * Decode flag: reject strings and keys that are not valid JSON string content.
+ *
+ * Malformed UTF-8, unescaped control characters, unknown or malformed escape
+ * sequences and unpaired surrogates are rejected. Without this flag they are
+ * accepted: unpaired surrogates become U+FFFD and malformed escape sequences
+ * are kept verbatim.
+ */
+#define JSON_DECODE_STRICT 0x02
+
+/**
+ * Encode flag: write the members of every object sorted by key.
+ *
+ * Keys are compared byte by byte, so the order does not depend on the locale.
+ */
+#define JSON_ENCODE_SORT_KEYS 0x01
+
+/**
+ * Encode flag: keep arrays holding only scalar values on a single line.
+ *
+ * Only meaningful with a non-zero indentation.
+ */
+#define JSON_ENCODE_COMPACT_ARRAYS 0x02
+
 /**
  * Supported JSON Data Types.
  *
@@ -47,6 +130,13 @@ struct json {
    */
   enum JSONDataType type;
 
+  /**
+   * The JSON_FLAG_* flags of the current entry/node.
+   *
+   * @var unsigned int flags.
+   */
+  unsigned int flags;
+
   /**
    * The key for the current entry/node.
    *
@@ -54,17 +144,67 @@ struct json {
    */
   char *key;
 
+  /**
+   * The number of characters in the key.
+   *
+   * Keys are compared and encoded over this length, so it must be set along
+   * with the key, also for NUL terminated keys.
+   *
+   * @var size_t key_length.
+   */
+  size_t key_length;
+
   /**
    * The value for the current entry/node.
    *
+   * For numbers, booleans and short strings this points at the inline scalar
+   * storage of the node itself, so no separate allocation is needed.
+   *
    * @var char* value.
    */
   void *value;
+
+  /**
+   * The inline storage for scalar values.
+   *
+   * The member in use is selected by the node type: `number` for JSON_number,
+   * `boolean` for JSON_boolean, `string` for short JSON_string values and
+   * `view` for JSON_string values flagged with JSON_FLAG_VALUE_VIEW. Numbers
+   * flagged with JSON_FLAG_INTEGER also use `integer`, whose `number` member
+   * overlays `number`. JSON_object and JSON_array nodes use `children`,
+   * which tracks their last child and either the number of children or the
+   * hash index of the keys of large objects (the vector of the elements of
+   * long arrays), built on first use. Both are maintained by json_push(),
+   * json_push_multiple() and json_remove(), so that value chains must only be
+   * changed through them.
+   *
+   * @var union json_scalar scalar.
+   */
+  union json_scalar {
+    double number;
+    struct json_integer_scalar {
+      double number;
+      int64_t value;
+    } integer;
+    int boolean;
+    char string[JSON_INLINE_STRING_SIZE];
+    struct json_string_view {
+      size_t length;
+      char *text;
+    } view;
+    struct json_children {
+      struct json *tail;
+      uintptr_t state;
+    } children;
+  } scalar;
 };
 
 /*
  * Create a new JSON object instance.
  *
+ * The instance takes ownership of the given value. Number and boolean values
+ * are moved into the node inline storage and the given pointer is freed.
+ *
  * @param enum JSONDataType type
  *   The Supported JSON Data Type.
  * @param void* value
@@ -86,6 +226,115 @@ struct json *json_create(enum JSONDataType type, void *value);
  */
 struct json *json_decode(const char *json_string);
 
+/**
+ * The data struct definition for a memory allocator.
+ *
+ * The callbacks follow the contracts of malloc(), realloc() and free(), and
+ * receive the context as their first argument.
+ */
+struct json_allocator {
+
+  /**
+   * Allocates the given number of bytes.
+   *
+   * @var void* (*alloc)(void *context, size_t size).
+   */
+  void *(*alloc)(void *context, size_t size);
+
+  /**
+   * Resizes memory returned by alloc or realloc.
+   *
+   * @var void* (*realloc)(void *context, void *pointer, size_t size).
+   */
+  void *(*realloc)(void *context, void *pointer, size_t size);
+
+  /**
+   * Releases memory returned by alloc or realloc.
+   *
+   * @var void (*free)(void *context, void *pointer).
+   */
+  void (*free)(void *context, void *pointer);
+
+  /**
+   * The user context passed to the callbacks.
+   *
+   * @var void* context.
+   */
+  void *context;
+};
+
+/**
+ * The options that control how a JSON encoded string is decoded.
+ */
+struct json_decode_options {
+
+  /**
+   * The maximum nesting depth of arrays and objects.
+   *
+   * Deeper input is rejected. Use 0 to select JSON_DEFAULT_MAX_DEPTH.
+   *
+   * @var size_t max_depth.
+   */
+  size_t max_depth;
+
+  /**
+   * The JSON_DECODE_* flags.
+   *
+   * @var int flags.
+   */
+  int flags;
+
+  /**
+   * The allocator of the buffers the call releases itself, or NULL for the
+   * default allocator.
+   *
+   * It serves the decoder stack and structural index, the contents of files
+   * that cannot be mapped, the state of incremental parsers and the batches
+   * of json_decode_lines(). Trees are released by json_destroy() and always
+   * come from the default allocator; documents use their own. The allocator
+   * must outlive the call, or the parser.
+   *
+   * @var const struct json_allocator* allocator.
+   */
+  const struct json_allocator *allocator;
+};
+
+/**
+ * Takes a JSON encoded string and converts it into a JSON object using the given options.
+ *
+ * @param const char* json_string
+ *   The json string being decoded.
+ * @param const struct json_decode_options* options
+ *   The decoding options, or NULL to use the defaults.
+ *
+ * @return struct json*
+ *   The pointer to the JSON object, otherwise NULL.
+ */
+struct json *json_decode_with_options(const char *json_string, const struct json_decode_options *options);
+
+/**
+ * Takes a JSON encoded buffer of the given length and converts it into a JSON object.
+ *
+ * The buffer does not need to be NUL terminated and is never read past its
+ * length. Decoding stops at the end of the first JSON value, so a buffer that
+ * holds several JSON values can be decoded back to back by moving it forward
+ * by the reported offset.
+ *
+ * @param const char* buffer
+ *   The json buffer being decoded.
+ * @param size_t length
+ *   The number of characters in the buffer.
+ * @param size_t* offset
+ *   Receives the offset of the first character after the decoded value, or
+ *   the offset of the offending character on errors. May be NULL.
+ * @param const struct json_decode_options* options
+ *   The decoding options, or NULL to use the defaults.
+ *
+ * @return struct json*
+ *   The pointer to the JSON object, otherwise NULL.
+ */
+struct json *json_decode_n(const char *buffer, size_t length, size_t *offset, const struct json_decode_options *options);
+
 /**
  * Returns a string containing the JSON representation of the supplied JSON object.
  *
@@ -97,9 +346,253 @@ struct json *json_decode(const char *json_string);
  */
 char *json_encode(struct json *object);
 
+/**
+ * Returns a string containing the JSON representation of the supplied JSON object, allocated once.
+ *
+ * The encoded size is measured first with json_encoded_size(), so the string
+ * is allocated exactly and never grown. This trades a second walk of the
+ * object for the reallocations and copies of json_encode().
+ *
+ * @param struct json* object
+ *   The JSON object being encoded.
+ *
+ * @return char*
+ *   The string pointer containing the JSON representation, otherwise NULL.
+ */
+char *json_encode_exact(struct json *object);
+
+/**
+ * Measures the JSON representation of the supplied JSON object.
+ *
+ * Nothing is allocated besides a small scratch buffer.
+ *
+ * @param struct json* object
+ *   The JSON object being measured.
+ *
+ * @return size_t
+ *   The number of characters of the JSON representation, NUL terminator
+ *   excluded, or 0 if the object cannot be encoded.
+ */
+size_t json_encoded_size(struct json *object);
+
+/**
+ * Encodes the supplied JSON object into a caller-supplied buffer, without allocating.
+ *
+ * @param struct json* object
+ *   The JSON object being encoded.
+ * @param char* buffer
+ *   The destination buffer, NUL terminated when there is room left.
+ * @param size_t capacity
+ *   The number of characters the buffer can hold.
+ *
+ * @return size_t
+ *   The number of characters written, NUL terminator excluded, or 0 if the
+ *   JSON representation does not fit the buffer.
+ */
+size_t json_encode_into(struct json *object, char *buffer, size_t capacity);
+
+/**
+ * The kinds of destination a JSON object can be encoded to.
+ */
+enum json_sink_type {
+  JSON_SINK_CALLBACK,
+  JSON_SINK_FD,
+  JSON_SINK_BUFFER,
+  JSON_SINK_COUNT
+};
+
+/**
+ * The data struct definition for the destination of a streamed encoding.
+ *
+ * Use json_sink_callback(), json_sink_fd(), json_sink_buffer() or
+ * json_sink_count() to init it.
+ */
+struct json_sink {
+
+  /**
+   * The kind of destination.
+   *
+   * @var enum json_sink_type type.
+   */
+  enum json_sink_type type;
+
+  /**
+   * The write callback (JSON_SINK_CALLBACK).
+   *
+   * Returns 1 when the data was written; otherwise, 0 to stop the encoding.
+   *
+   * @var int (*write)(void *context, const char *data, size_t length).
+   */
+  int (*write)(void *context, const char *data, size_t length);
+
+  /**
+   * The context passed to the write callback (JSON_SINK_CALLBACK).
+   *
+   * @var void* context.
+   */
+  void *context;
+
+  /**
+   * The file descriptor (JSON_SINK_FD).
+   *
+   * @var int fd.
+   */
+  int fd;
+
+  /**
+   * The fixed buffer (JSON_SINK_BUFFER).
+   *
+   * @var char* buffer.
+   */
+  char *buffer;
+
+  /**
+   * The number of characters the fixed buffer can hold (JSON_SINK_BUFFER).
+   *
+   * @var size_t capacity.
+   */
+  size_t capacity;
+
+  /**
+   * The number of characters written to the sink so far.
+   *
+   * @var size_t length.
+   */
+  size_t length;
+};
+
+/**
+ * Returns a sink handing the encoded characters to a write callback.
+ *
+ * @param int (*write)(void *context, const char *data, size_t length)
+ *   The write callback.
+ * @param void* context
+ *   The context passed to the write callback.
+ *
+ * @return struct json_sink
+ *   The sink.
+ */
+struct json_sink json_sink_callback(int (*write)(void *context, const char *data, size_t length), void *context);
+
+/**
+ * Returns a sink writing the encoded characters to a file descriptor.
+ *
+ * @param int fd
+ *   The file descriptor.
+ *
+ * @return struct json_sink
+ *   The sink.
+ */
+struct json_sink json_sink_fd(int fd);
+
+/**
+ * Returns a sink writing the encoded characters to a fixed buffer.
+ *
+ * The characters are written straight into the buffer, which is NUL
+ * terminated when there is room left for it.
+ *
+ * @param char* buffer
+ *   The buffer.
+ * @param size_t capacity
+ *   The number of characters the buffer can hold.
+ *
+ * @return struct json_sink
+ *   The sink.
+ */
+struct json_sink json_sink_buffer(char *buffer, size_t capacity);
+
+/**
+ * Returns a sink discarding the encoded characters and only counting them.
+ *
+ * @return struct json_sink
+ *   The sink.
+ */
+struct json_sink json_sink_count();
+
+/**
+ * Encodes the given JSON object to a sink.
+ *
+ * Callback and file descriptor sinks receive the encoded characters in
+ * batches of up to 64 KB, so the memory used does not depend on the size of
+ * the encoded JSON.
+ *
+ * @param struct json* object
+ *   The JSON object to encode.
+ * @param struct json_sink* sink
+ *   The destination; its length is updated with the characters written.
+ *
+ * @return int
+ *   Returns 1 when the encoding succeeded; otherwise, 0 (including when a
+ *   fixed buffer is too small or a write failed).
+ */
+int json_encode_to(struct json *object, struct json_sink *sink);
+
+/**
+ * The options that control how a JSON object is encoded.
+ */
+struct json_encode_options {
+
+  /**
+   * The number of spaces each nesting level is indented by.
+   *
+   * Use 0 to write the JSON representation on a single line without any
+   * whitespace, as json_encode() does.
+   *
+   * @var size_t indent.
+   */
+  size_t indent;
+
+  /**
+   * The JSON_ENCODE_* flags.
+   *
+   * @var int flags.
+   */
+  int flags;
+
+  /**
+   * The allocator of the returned string and of temporary buffers, or NULL
+   * for the default allocator.
+   *
+   * @var const struct json_allocator* allocator.
+   */
+  const struct json_allocator *allocator;
+};
+
+/**
+ * Returns a string containing the JSON representation of the supplied JSON object, using the given options.
+ *
+ * @param struct json* object
+ *   The JSON object being encoded.
+ * @param const struct json_encode_options* options
+ *   The encoding options, or NULL to use the defaults of json_encode().
+ *
+ * @return char*
+ *   The string pointer containing the JSON representation, otherwise NULL.
+ */
+char *json_encode_with_options(struct json *object, const struct json_encode_options *options);
+
+/**
+ * Encodes the given JSON object to a sink, using the given options.
+ *
+ * @param struct json* object
+ *   The JSON object to encode.
+ * @param struct json_sink* sink
+ *   The destination; its length is updated with the characters written.
+ * @param const struct json_encode_options* options
+ *   The encoding options, or NULL to use the defaults of json_encode().
+ *
+ * @return int
+ *   Returns 1 when the encoding succeeded; otherwise, 0.
+ */
+int json_encode_to_with_options(struct json *object, struct json_sink *sink, const struct json_encode_options *options);
+
 /**
  * Free the memory associted to a JSON object.
  *
+ * The object, its next siblings and all their descendants are released
+ * iteratively, so neither long sibling chains nor deep nesting can exhaust
+ * the C stack.
+ *
  * @param struct json* object
  *   The JSON object to be cleaned.
  */
@@ -117,145 +610,740 @@ void json_destroy(struct json *object);
  */
 void json_destroy_multiple(struct json **items, int size);
 
+/**
+ * Releases the nodes, keys and short strings cached by the calling thread.
+ *
+ * json_create() and the builder functions carve nodes, keys and strings of up
+ * to 127 characters from slabs of the calling thread, and reuse the blocks
+ * json_destroy() frees through a free list of the thread, so that trees built
+ * and destroyed over and over do not contend on the system allocator. A slab
+ * goes back to the allocator once every block carved from it is released.
+ * Each thread keeps a bounded number of free blocks, released when it exits;
+ * call this function to release them sooner, e.g. after destroying a large
+ * tree.
+ *
+ * @return size_t
+ *   The number of bytes of slabs returned to the allocator.
+ */
+size_t json_pool_trim(void);
+
+/**
+ * Sets the allocator used for every library allocation.
+ *
+ * Nodes, keys, values, indexes and returned strings are allocated with it,
+ * unless a document or encode options name another allocator. Call it before
+ * any other library function, or at least while no tree, document or string
+ * allocated with the previous allocator is alive and after every other thread
+ * called json_pool_trim().
+ *
+ * Values handed over to json_create() must come from the same allocator.
+ *
+ * @param const struct json_allocator* allocator
+ *   The allocator, copied by the library, or NULL to restore malloc(),
+ *   realloc() and free().
+ *
+ * @return int
+ *   Returns 1 on success; otherwise, 0 (if a callback is missing).
+ */
+int json_set_allocator(const struct json_allocator *allocator);
+
+/**
+ * Releases memory returned by the library, such as json_encode() strings.
+ *
+ * @param void* pointer
+ *   The memory to release, allocated with the default allocator. May be NULL.
+ */
+void json_free(void *pointer);
+
 #endif /* JSON_H */
 
+#ifndef JSON_DOCUMENT_H
+#define JSON_DOCUMENT_H
+
+/**
+ * A JSON document that owns the memory of the JSON objects decoded into it.
+ *
+ * Every node, key and value decoded into a document is carved out of a single
+ * arena, so decoding does not call malloc per value and the whole tree is
+ * released with a handful of free calls. Nodes owned by a document must not be
+ * passed to json_destroy().
+ */
+struct json_document;
+
+/**
+ * Create a new, empty JSON document.
+ *
+ * @return struct json_document*
+ *   The pointer to the JSON document, otherwise NULL.
+ */
+struct json_document *json_document_create();
+
+/**
+ * Create a new, empty JSON document whose memory comes from the given allocator.
+ *
+ * The arena blocks of the document, and the temporary buffers used to decode
+ * into it, are allocated with the allocator, e.g. to keep a request document
+ * on the memory of the socket processing it.
+ *
+ * @param const struct json_allocator* allocator
+ *   The allocator, copied by the document, or NULL for the default allocator.
+ *   Every callback must be set, as for json_set_allocator().
+ *
+ * @return struct json_document*
+ *   The pointer to the JSON document, otherwise NULL.
+ */
+struct json_document *json_document_create_with_allocator(const struct json_allocator *allocator);
+
+/**
+ * Takes a JSON encoded string and decodes it into the given JSON document.
+ *
+ * The decoded JSON object stays valid until the document is reset or freed.
+ *
+ * @param struct json_document* document
+ *   The JSON document that will own the decoded JSON object.
+ * @param const char* json_string
+ *   The json string being decoded.
+ *
+ * @return struct json*
+ *   The pointer to the JSON object, otherwise NULL.
+ */
+struct json *json_decode_into(struct json_document *document, const char *json_string);
+
+/**
+ * Returns the JSON object most recently decoded into the given document.
+ *
+ * @param struct json_document* document
+ *   The JSON document.
+ *
+ * @return struct json*
+ *   The pointer to the JSON object, otherwise NULL.
+ */
+struct json *json_document_root(struct json_document *document);
+
+/**
+ * Sets the options used by the following decodes into the given document.
+ *
+ * With JSON_DECODE_ZERO_COPY, decoded strings and keys reference the input
+ * string, which must then outlive the document contents.
+ *
+ * @param struct json_document* document
+ *   The JSON document.
+ * @param const struct json_decode_options* options
+ *   The decoding options, or NULL to restore the defaults.
+ */
+void json_document_set_options(struct json_document *document, const struct json_decode_options *options);
+
+/**
+ * Reads the given JSON file path and decodes its contents into the document.
+ *
+ * Regular files are memory mapped and decoded in place instead of being read
+ * into a buffer. The mapping is owned by the document until it is reset or
+ * freed, so zero-copy views (JSON_DECODE_ZERO_COPY) may keep referencing it.
+ *
+ * @param struct json_document* document
+ *   The document that owns the decoded JSON object.
+ * @param const char* filepath
+ *   The filepath with the model content.
+ *
+ * @return struct json*
+ *   The pointer to the decoded JSON object, otherwise NULL.
+ */
+struct json *json_document_open(struct json_document *document, const char *filepath);
+
+/**
+ * Releases every JSON object owned by the document, keeping its memory for reuse.
+ *
+ * @param struct json_document* document
+ *   The JSON document to reset.
+ */
+void json_document_reset(struct json_document *document);
+
+/**
+ * Free the memory associated to a JSON document and every JSON object it owns.
+ *
+ * @param struct json_document* document
+ *   The JSON document to be cleaned.
+ */
+void json_document_free(struct json_document *document);
+
+#endif /* JSON_DOCUMENT_H */
+
 #ifndef JSON_ITERATOR_H
 #define JSON_ITERATOR_H
 
+/*
+ * The functions of this section, json_path_eval() and the json_tape_*
+ * readers only read the tree: they are reentrant and may be called from
+ * several threads at once on the same tree, as long as no thread modifies it.
+ * The key indexes and element vectors built by the first lookups are
+ * published atomically; call json_build_indexes() once beforehand so that no
+ * read allocates at all.
+ */
+
+/**
+ * Find node in the given JSON object.
+ *
+ * The path is read in place, without any allocation; empty keys are skipped.
+ *
+ * @param struct json* object
+ *   The JSON object to search.
+ * @param const char* path
+ *   The path to find the node.
+ * @param const char delimiter
+ *   The path delimiter.
+ *
+ * @return struct json*
+ *   The pointer to the JSON node object, if found; otherwise NULL.
+ */
+struct json *json_find_node(struct json *object, const char *path, const char delimiter);
+
+/**
+ * Builds the lookup structures of every large object and array of a tree.
+ *
+ * Objects of many members get their key index and long arrays their element
+ * vector, which the first lookups would otherwise build lazily. Call it after
+ * building or decoding a tree shared by several reader threads. Trees decoded
+ * into a document get them while decoded, and cannot rebuild them once pushed
+ * members outgrow them.
+ *
+ * @param struct json* object
+ *   The root of the tree.
+ *
+ * @return int
+ *   Returns 1 on success; otherwise, 0 (e.g. on allocation failure).
+ */
+int json_build_indexes(struct json *object);
+
+/**
+ * Find node by index in the given JSON object.
+ *
+ * Arrays are indexed by position, objects by the key holding the decimal
+ * representation of the index.
+ *
+ * @param struct json* object
+ *   The JSON object to search.
+ * @param const int index
+ *   The index to search.
+ *
+ * @return struct json*
+ *   The pointer to the JSON node object, if found; otherwise NULL.
+ */
+struct json *json_find_node_by_index(struct json *object, const int index);
+
+/**
+ * Returns the element at the given position of a JSON array.
+ *
+ * Long arrays get a vector of their elements on the first call, so that
+ * every access by index takes constant time from then on.
+ *
+ * @param const struct json* array
+ *   The JSON array.
+ * @param size_t index
+ *   The zero-based position of the element.
+ *
+ * @return struct json*
+ *   The pointer to the element, if found; otherwise NULL.
+ */
+struct json *json_array_get(const struct json *array, size_t index);
+
+/**
+ * Returns the number of elements of a JSON array.
+ *
+ * @param const struct json* array
+ *   The JSON array.
+ *
+ * @return size_t
+ *   The number of elements, or 0 if the node is not a JSON array.
+ */
+size_t json_array_size(const struct json *array);
+
+/**
+ * Returns the value of a JSON number node.
+ *
+ * The value is read from the inline storage of the node.
+ *
+ * @param const struct json* node
+ *   The JSON number node.
+ *
+ * @return double
+ *   The number value, or 0 if the node is not a JSON number.
+ */
+double json_number_value(const struct json *node);
+
+/**
+ * Returns the value of a JSON number node as an integer.
+ *
+ * Numbers flagged with JSON_FLAG_INTEGER return their exact value, except
+ * those also flagged with JSON_FLAG_UNSIGNED, which saturate to INT64_MAX;
+ * use json_unsigned_value() for those. Other numbers out of the int64_t
+ * range saturate to INT64_MIN or INT64_MAX as well.
+ *
+ * @param const struct json* node
+ *   The JSON number node.
+ *
+ * @return int64_t
+ *   The number value truncated to an integer, or 0 if the node is not a JSON
+ *   number (or is NaN).
+ */
+int64_t json_integer_value(const struct json *node);
+
+/**
+ * Returns the value of a JSON number node as an unsigned integer.
+ *
+ * @param const struct json* node
+ *   The JSON number node.
+ *
+ * @return uint64_t
+ *   The exact value of integers flagged with JSON_FLAG_UNSIGNED, the number
+ *   value truncated and clamped to [0, UINT64_MAX] otherwise, or 0 if the
+ *   node is not a JSON number.
+ */
+uint64_t json_unsigned_value(const struct json *node);
+
+/**
+ * Checks whether a JSON number node holds an exact 64-bit integer.
+ *
+ * @param const struct json* node
+ *   The JSON number node.
+ *
+ * @return int
+ *   1 when the node is flagged with JSON_FLAG_INTEGER; otherwise, 0.
+ */
+int json_is_integer(const struct json *node);
+
+/**
+ * Returns the value of a JSON boolean node.
+ *
+ * @param const struct json* node
+ *   The JSON boolean node.
+ *
+ * @return int
+ *   1 for true, 0 for false or if the node is not a JSON boolean.
+ */
+int json_bool_value(const struct json *node);
+
+/**
+ * Returns the value of a JSON string node.
+ *
+ * Zero-copy views are not NUL terminated, so NULL is returned for them unless
+ * they contain escape sequences; use json_string_view() instead.
+ *
+ * @param const struct json* node
+ *   The JSON string node.
+ *
+ * @return const char*
+ *   The NUL terminated string value, or NULL if the node is not a JSON string.
+ */
+const char *json_string_value(const struct json *node);
+
+/**
+ * Returns the characters and length of a JSON string node.
+ *
+ * This works for every string node, including zero-copy views. Strings with
+ * escape sequences are materialized on first access; this is safe to call
+ * concurrently.
+ *
+ * @param const struct json* node
+ *   The JSON string node.
+ * @param size_t* length
+ *   Receives the number of characters in the string. May be NULL.
+ *
+ * @return const char*
+ *   The string characters, or NULL if the node is not a JSON string.
+ */
+const char *json_string_view(const struct json *node, size_t *length);
+
+/**
+ * Converts a JSON value to a double.
+ *
+ * Prefer json_number_value(), which reads the node inline storage directly.
+ *
+ * This function assumes that the JSON value is stored as a double. It performs
+ * a type cast to retrieve the double value.
+ *
+ * @param void *value
+ *   Pointer to the JSON value, which should be stored as a double.
+ *
+ * @return double
+ *   The double value extracted from the JSON value.
+ */
+double json_value_to_double(void *value);
+
+/**
+ * Converts a JSON number value to an integer.
+ *
+ * This function converts the JSON number (stored as a double) to an integer.
+ * Prefer json_integer_value(), which reads the node inline storage directly.
+ *
+ * @param void *value
+ *   Pointer to the JSON value, which should be a number stored as a double.
+ *
+ * @return int
+ *   The integer value obtained by casting the double value.
+ */
+int json_number_value_to_int(void *value);
+
+/**
+ * Converts a JSON number string value to a long double.
+ *
+ * This function converts the numeric string in the JSON value to a long double.
+ *
+ * @param void *value
+ *   Pointer to the JSON value, which should be a numeric string.
+ *
+ * @return long double
+ *   The long double value parsed from the numeric string.
+ */
+long double json_number_string_value_to_long_double(void *value);
+
+/**
+ * Retrieves an array from a JSON object based on the specified path.
+ *
+ * This function finds a JSON node at the given path and retrieves it if it
+ * is of type JSON_array.
+ *
+ * @param struct json *json_object
+ *   Pointer to the JSON object from which to retrieve the array.
+ * @param const char *path
+ *   Path to the JSON node.
+ *
+ * @return struct json*
+ *   Pointer to the JSON array if found and of type JSON_array, otherwise NULL.
+ */
+struct json *json_get_array(struct json *json_object, const char *path);
+
+/**
+ * Retrieves an object from a JSON object based on the specified path.
+ *
+ * This function searches for a JSON node at the specified path and returns
+ * it if it is of type JSON_object. If the node does not exist or is not
+ * an object, the function returns NULL.
+ *
+ * @param struct json *json_object
+ *   Pointer to the JSON object from which the JSON object is to be retrieved.
+ * @param const char *path
+ *   The path to the JSON node to be retrieved.
+ *
+ * @return struct json*
+ *   Pointer to the JSON object if found and of type JSON_object, otherwise NULL.
+ */
+struct json *json_get_object(struct json *json_object, const char *path);
+
+/**
+ * Retrieves a numeric value from a JSON object based on the specified path.
+ *
+ * This function finds a JSON node at the given path and retrieves its value if
+ * it is of type JSON_number.
+ *
+ * @param struct json *json_object
+ *   Pointer to the JSON object from which to retrieve the value.
+ * @param const char *path
+ *   Path to the JSON node.
+ *
+ * @return void*
+ *   Pointer to the JSON value if found and of type JSON_number, otherwise NULL.
+ */
+void *json_get_number(struct json *json_object, const char *path);
+
+/**
+ * Retrieves a numeric string value from a JSON object based on the specified path.
+ *
+ * This function finds a JSON node at the given path and retrieves its value if
+ * it is of type JSON_string.
+ *
+ * @param struct json *json_object
+ *   Pointer to the JSON object from which to retrieve the value.
+ * @param const char *path
+ *   Path to the JSON node.
+ *
+ * @return void*
+ *   Pointer to the JSON value if found and of type JSON_string, otherwise NULL.
+ */
+void *json_get_number_string(struct json *json_object, const char *path);
+
+#endif /* JSON_ITERATOR_H */
+
+#ifndef JSON_PATH_H
+#define JSON_PATH_H
+
+/**
+ * The data struct definition for a compiled JSON path.
+ *
+ * Its fields are private; use json_path_compile() to create it.
+ */
+struct json_path;
+
+/**
+ * Compiles a path for repeated lookups with json_path_eval().
+ *
+ * The path is split into segments once, and the hash of every key and the
+ * value of every array index are computed up front. Empty segments are
+ * skipped, as json_find_node() does.
+ *
+ * @param const char* path
+ *   The path, e.g. "a.b.3.c".
+ * @param const char delimiter
+ *   The path delimiter.
+ *
+ * @return struct json_path*
+ *   The pointer to the compiled path, otherwise NULL (including for paths
+ *   without any segment).
+ */
+struct json_path *json_path_compile(const char *path, const char delimiter);
+
+/**
+ * Finds the node a compiled path leads to in the given JSON object.
+ *
+ * Segments select object members by key and, in arrays, elements by their
+ * zero-based position. Nothing is allocated, and the compiled path may be
+ * evaluated from several threads at once.
+ *
+ * @param struct json* object
+ *   The JSON object to search.
+ * @param const struct json_path* path
+ *   The compiled path.
+ *
+ * @return struct json*
+ *   The pointer to the JSON node object, if found; otherwise NULL.
+ */
+struct json *json_path_eval(struct json *object, const struct json_path *path);
+
+/**
+ * Free the memory associated to a compiled path.
+ *
+ * @param struct json_path* path
+ *   The compiled path.
+ */
+void json_path_free(struct json_path *path);
+
+#endif /* JSON_PATH_H */
+
+#ifndef JSON_TAPE_H
+#define JSON_TAPE_H
+
+/**
+ * The data struct definition for a JSON tape.
+ *
+ * A tape is a read-only document stored as a single array of 64-bit words,
+ * one per value (two per number), with keys and strings unescaped into one
+ * side buffer. Containers record where they end, so siblings are skipped in
+ * constant time. Its fields are private; use json_tape_decode() to create it.
+ */
+struct json_tape;
+
+/**
+ * The data struct definition for a value on a JSON tape.
+ *
+ * Values are small handles passed by value; they stay valid as long as the
+ * tape they belong to. Their fields are private.
+ */
+struct json_tape_value {
+
+  /**
+   * The tape the value belongs to.
+   *
+   * @var const struct json_tape* tape.
+   */
+  const struct json_tape *tape;
+
+  /**
+   * The index of the first word of the value.
+   *
+   * @var size_t index.
+   */
+  size_t index;
+
+  /**
+   * The index of the key word of object members, SIZE_MAX otherwise.
+   *
+   * @var size_t key.
+   */
+  size_t key;
+};
+
+/**
+ * Decodes the first JSON value of a buffer into a tape.
+ *
+ * The JSON_DECODE_ZERO_COPY flag is ignored: the tape always owns its strings.
+ *
+ * @param const char* buffer
+ *   The JSON text, not necessarily NUL terminated.
+ * @param size_t length
+ *   The number of characters in the buffer.
+ * @param size_t* offset
+ *   Receives the offset where decoding stopped, as in json_decode_n(). May be
+ *   NULL.
+ * @param const struct json_decode_options* options
+ *   The decoding options, or NULL for the defaults.
+ *
+ * @return struct json_tape*
+ *   The pointer to the tape, otherwise NULL.
+ */
+struct json_tape *json_tape_decode(const char *buffer, size_t length, size_t *offset, const struct json_decode_options *options);
+
+/**
+ * Returns the root value of a tape.
+ *
+ * @param const struct json_tape* tape
+ *   The tape instance.
+ *
+ * @return struct json_tape_value
+ *   The root value.
+ */
+struct json_tape_value json_tape_root(const struct json_tape *tape);
+
 /**
- * Find node in the given JSON object.
+ * Returns the type of a tape value.
  *
- * @param struct json* object
- *   The JSON object to search.
- * @param const char* path
- *   The path to find the node.
- * @param const char delimiter
- *   The path delimiter.
+ * @param struct json_tape_value value
+ *   The tape value.
  *
- * @return struct json*
- *   The pointer to the JSON node object, if found; otherwise NULL.
+ * @return enum JSONDataType
+ *   The type of the value.
  */
-struct json *json_find_node(struct json *object, const char *path, const char delimiter);
+enum JSONDataType json_tape_type(struct json_tape_value value);
 
 /**
- * Find node by index in the given JSON object.
+ * Moves to the first member or element of a container.
  *
- * @param struct json* object
- *   The JSON object to search.
- * @param const int index
- *   The index to search.
+ * @param struct json_tape_value container
+ *   The object or array value.
+ * @param struct json_tape_value* child
+ *   Receives the first member or element.
  *
- * @return struct json*
- *   The pointer to the JSON node object, if found; otherwise NULL.
+ * @return int
+ *   Returns 1 if the container has a child; otherwise, 0.
  */
-struct json *json_find_node_by_index(struct json *object, const int index);
+int json_tape_first(struct json_tape_value container, struct json_tape_value *child);
 
 /**
- * Converts a JSON value to a double.
+ * Moves to the next member or element of the same container.
  *
- * This function assumes that the JSON value is stored as a double. It performs
- * a type cast to retrieve the double value.
+ * @param struct json_tape_value* value
+ *   The current member or element, replaced by the next one.
  *
- * @param void *value
- *   Pointer to the JSON value, which should be stored as a double.
+ * @return int
+ *   Returns 1 if there is a next sibling; otherwise, 0.
+ */
+int json_tape_next(struct json_tape_value *value);
+
+/**
+ * Returns the key of an object member.
  *
- * @return double
- *   The double value extracted from the JSON value.
+ * @param struct json_tape_value value
+ *   The member value.
+ * @param size_t* length
+ *   Receives the number of characters in the key. May be NULL.
+ *
+ * @return const char*
+ *   The NUL terminated key, or NULL if the value is not an object member.
  */
-double json_value_to_double(void *value);
+const char *json_tape_key(struct json_tape_value value, size_t *length);
 
 /**
- * Converts a JSON number value to an integer.
+ * Finds the value a path leads to, as json_find_node() does.
  *
- * This function converts the JSON number (stored as a double) to an integer.
+ * The path is read in place; nothing is allocated.
  *
- * @param void *value
- *   Pointer to the JSON value, which should be a number stored as a double.
+ * @param struct json_tape_value object
+ *   The value to search.
+ * @param const char* path
+ *   The path, e.g. "a.b.3.c".
+ * @param const char delimiter
+ *   The path delimiter.
+ * @param struct json_tape_value* result
+ *   Receives the value found.
  *
  * @return int
- *   The integer value obtained by casting the double value.
+ *   Returns 1 if the value was found; otherwise, 0.
  */
-int json_number_value_to_int(void *value);
+int json_tape_find(struct json_tape_value object, const char *path, const char delimiter, struct json_tape_value *result);
 
 /**
- * Converts a JSON number string value to a long double.
- *
- * This function converts the numeric string in the JSON value to a long double.
+ * Finds the value a compiled path leads to.
  *
- * @param void *value
- *   Pointer to the JSON value, which should be a numeric string.
+ * @param struct json_tape_value object
+ *   The value to search.
+ * @param const struct json_path* path
+ *   The path compiled with json_path_compile().
+ * @param struct json_tape_value* result
+ *   Receives the value found.
  *
- * @return long double
- *   The long double value parsed from the numeric string.
+ * @return int
+ *   Returns 1 if the value was found; otherwise, 0.
  */
-long double json_number_string_value_to_long_double(void *value);
+int json_tape_path_eval(struct json_tape_value object, const struct json_path *path, struct json_tape_value *result);
 
 /**
- * Retrieves an array from a JSON object based on the specified path.
+ * Returns the characters of a string value.
  *
- * This function finds a JSON node at the given path and retrieves it if it
- * is of type JSON_array.
+ * @param struct json_tape_value value
+ *   The tape value.
+ * @param size_t* length
+ *   Receives the number of characters. May be NULL.
  *
- * @param struct json *json_object
- *   Pointer to the JSON object from which to retrieve the array.
- * @param const char *path
- *   Path to the JSON node.
+ * @return const char*
+ *   The NUL terminated string, or NULL if the value is not a string.
+ */
+const char *json_tape_string(struct json_tape_value value, size_t *length);
+
+/**
+ * Returns the value of a number as a double.
  *
- * @return struct json*
- *   Pointer to the JSON array if found and of type JSON_array, otherwise NULL.
+ * @param struct json_tape_value value
+ *   The tape value.
+ *
+ * @return double
+ *   The number, or 0 if the value is not a number.
  */
-struct json *json_get_array(struct json *json_object, const char *path);
+double json_tape_number(struct json_tape_value value);
 
 /**
- * Retrieves an object from a JSON object based on the specified path.
+ * Returns the value of a number as a signed 64-bit integer.
  *
- * This function searches for a JSON node at the specified path and returns
- * it if it is of type JSON_object. If the node does not exist or is not
- * an object, the function returns NULL.
+ * Integers are exact, except unsigned integers above INT64_MAX, which saturate
+ * to INT64_MAX; other numbers are truncated, saturating to INT64_MIN or
+ * INT64_MAX out of range.
  *
- * @param struct json *json_object
- *   Pointer to the JSON object from which the JSON object is to be retrieved.
- * @param const char *path
- *   The path to the JSON node to be retrieved.
+ * @param struct json_tape_value value
+ *   The tape value.
  *
- * @return struct json*
- *   Pointer to the JSON object if found and of type JSON_object, otherwise NULL.
+ * @return int64_t
+ *   The integer, or 0 if the value is not a number.
  */
-struct json *json_get_object(struct json *json_object, const char *path);
+int64_t json_tape_integer(struct json_tape_value value);
 
 /**
- * Retrieves a numeric value from a JSON object based on the specified path.
- *
- * This function finds a JSON node at the given path and retrieves its value if
- * it is of type JSON_number.
+ * Returns the value of a boolean.
  *
- * @param struct json *json_object
- *   Pointer to the JSON object from which to retrieve the value.
- * @param const char *path
- *   Path to the JSON node.
+ * @param struct json_tape_value value
+ *   The tape value.
  *
- * @return void*
- *   Pointer to the JSON value if found and of type JSON_number, otherwise NULL.
+ * @return int
+ *   Returns 1 if the value is true; otherwise, 0.
  */
-void *json_get_number(struct json *json_object, const char *path);
+int json_tape_bool(struct json_tape_value value);
 
 /**
- * Retrieves a numeric string value from a JSON object based on the specified path.
+ * Returns the number of bytes held by a tape.
  *
- * This function finds a JSON node at the given path and retrieves its value if
- * it is of type JSON_string.
+ * @param const struct json_tape* tape
+ *   The tape instance.
  *
- * @param struct json *json_object
- *   Pointer to the JSON object from which to retrieve the value.
- * @param const char *path
- *   Path to the JSON node.
+ * @return size_t
+ *   The size of the words and strings in use.
+ */
+size_t json_tape_memory(const struct json_tape *tape);
+
+/**
+ * Free the memory associated to a tape.
  *
- * @return void*
- *   Pointer to the JSON value if found and of type JSON_string, otherwise NULL.
+ * @param struct json_tape* tape
+ *   The tape instance.
  */
-void *json_get_number_string(struct json *json_object, const char *path);
+void json_tape_free(struct json_tape *tape);
 
-#endif /* JSON_ITERATOR_H */
+#endif /* JSON_TAPE_H */
 
 #ifndef JSON_BUILDER_H
 #define JSON_BUILDER_H
@@ -282,14 +1370,25 @@ struct json *json_string(const char *string);
  */
 struct json *json_number(const double number);
 
+/**
+ * Create a JSON number instance holding an exact 64-bit integer.
+ *
+ * @param const int64_t integer
+ *   The object integer value.
+ *
+ * @return struct json*
+ *   Returns the JSON number instance; otherwise, NULL.
+ */
+struct json *json_integer(const int64_t integer);
+
 /**
  * Converts a double number to a JSON string representation.
  *
  * This function takes a double precision number and converts it into
- * a JSON string representation. It first converts the number to a
- * string using the `ldtos` function, and then creates a JSON object
- * using this string. If the conversion or the JSON object creation
- * fails, it returns NULL.
+ * a JSON string representation. It first converts the number to the
+ * shortest string that reads back to the same value, and then creates
+ * a JSON object using this string. If the JSON object creation fails,
+ * it returns NULL.
  *
  * @param const double number
  *   The object number value.
@@ -365,6 +1464,19 @@ struct json *json_object_string(const char *key, const char *string);
  */
 struct json *json_object_number(const char *key, const double number);
 
+/**
+ * Create a JSON integer object instance.
+ *
+ * @param const char* key
+ *   The object key.
+ * @param const int64_t integer
+ *   The object integer value.
+ *
+ * @return struct json*
+ *   Returns the JSON object instance; otherwise, NULL.
+ */
+struct json *json_object_integer(const char *key, const int64_t integer);
+
 /**
  * Creates a JSON number string object instance.
  *
@@ -401,6 +1513,21 @@ struct json *json_array();
  */
 void json_push(struct json *container, struct json *child);
 
+/**
+ * Removes the member with the given key from a JSON object and destroys it.
+ *
+ * Only the first member is removed when the key is duplicated.
+ *
+ * @param struct json* container
+ *   The container JSON object, whose value is the first member.
+ * @param const char* key
+ *   The key of the member to remove.
+ *
+ * @return int
+ *   Returns 1 when a member was removed; otherwise, 0.
+ */
+int json_remove(struct json *container, const char *key);
+
 /**
  * Adds multiple JSON items to a container JSON object.
  *
@@ -419,3 +1546,316 @@ void json_push(struct json *container, struct json *child);
 int json_push_multiple(struct json *container, struct json **items, int size);
 
 #endif /* JSON_BUILDER_H */
+
+#ifndef JSON_SAX_H
+#define JSON_SAX_H
+
+/**
+ * The data struct definition for the callbacks of the event based parser.
+ *
+ * Every callback receives the context given to json_sax_parse() and returns 1
+ * to continue parsing or 0 to stop it. Callbacks left NULL are skipped,
+ * except on_integer and on_unsigned, whose values are then reported to
+ * on_number. Keys and strings point into the parsed buffer and are not NUL
+ * terminated: they are the raw characters between the double quotes, with
+ * their escape sequences left unresolved. Pass them to json_sax_unescape() to
+ * get their value.
+ */
+struct json_sax_handler {
+
+  /**
+   * Called when an object starts.
+   *
+   * @var int (*on_object_start)(void *context).
+   */
+  int (*on_object_start)(void *context);
+
+  /**
+   * Called when an object ends.
+   *
+   * @var int (*on_object_end)(void *context).
+   */
+  int (*on_object_end)(void *context);
+
+  /**
+   * Called when an array starts.
+   *
+   * @var int (*on_array_start)(void *context).
+   */
+  int (*on_array_start)(void *context);
+
+  /**
+   * Called when an array ends.
+   *
+   * @var int (*on_array_end)(void *context).
+   */
+  int (*on_array_end)(void *context);
+
+  /**
+   * Called for every object key, before the key value events, with its raw
+   * characters.
+   *
+   * @var int (*on_key)(void *context, const char *key, size_t length).
+   */
+  int (*on_key)(void *context, const char *key, size_t length);
+
+  /**
+   * Called for every string value, with its raw characters.
+   *
+   * @var int (*on_string)(void *context, const char *value, size_t length).
+   */
+  int (*on_string)(void *context, const char *value, size_t length);
+
+  /**
+   * Called for every number value that is not reported to on_integer or on_unsigned.
+   *
+   * @var int (*on_number)(void *context, double value).
+   */
+  int (*on_number)(void *context, double value);
+
+  /**
+   * Called for every boolean value.
+   *
+   * @var int (*on_boolean)(void *context, int value).
+   */
+  int (*on_boolean)(void *context, int value);
+
+  /**
+   * Called for every null value.
+   *
+   * @var int (*on_null)(void *context).
+   */
+  int (*on_null)(void *context);
+
+  /**
+   * Called for every integer value that fits an int64_t, when set.
+   *
+   * @var int (*on_integer)(void *context, int64_t value).
+   */
+  int (*on_integer)(void *context, int64_t value);
+
+  /**
+   * Called for every integer value above INT64_MAX that fits an uint64_t, when set.
+   *
+   * @var int (*on_unsigned)(void *context, uint64_t value).
+   */
+  int (*on_unsigned)(void *context, uint64_t value);
+};
+
+/**
+ * Parses a JSON encoded buffer and reports its values to the given callbacks.
+ *
+ * No JSON object is created: the memory used does not depend on the size of
+ * the buffer, only on its nesting depth. Like json_decode_n(), parsing stops
+ * at the end of the first JSON value and the buffer does not need to be NUL
+ * terminated.
+ *
+ * @param const char* buffer
+ *   The json buffer being parsed.
+ * @param size_t length
+ *   The number of characters in the buffer.
+ * @param size_t* offset
+ *   Receives the offset of the first character after the parsed value, or
+ *   the offset of the offending character on errors. May be NULL.
+ * @param const struct json_decode_options* options
+ *   The decoding options, or NULL to use the defaults.
+ * @param const struct json_sax_handler* handler
+ *   The callbacks.
+ * @param void* context
+ *   The context passed to every callback.
+ *
+ * @return int
+ *   Returns 1 when the whole value was parsed; otherwise, 0 on syntax errors
+ *   or when a callback stopped the parsing.
+ */
+int json_sax_parse(const char *buffer, size_t length, size_t *offset, const struct json_decode_options *options, const struct json_sax_handler *handler, void *context);
+
+/**
+ * Resolves the escape sequences of a key or string reported to a handler.
+ *
+ * \uXXXX sequences, including surrogate pairs, are written as UTF-8. The
+ * result is never longer than the raw characters and is not NUL terminated.
+ *
+ * @param char* destination
+ *   The destination, at least length bytes long and not overlapping the raw
+ *   characters.
+ * @param const char* characters
+ *   The raw characters received by on_key or on_string.
+ * @param size_t length
+ *   The number of raw characters.
+ * @param int flags
+ *   The JSON_DECODE_* flags: with JSON_DECODE_STRICT, invalid string content
+ *   is rejected; otherwise, malformed escape sequences are kept verbatim and
+ *   unpaired surrogates become U+FFFD.
+ * @param size_t* written_length
+ *   Receives the number of characters written to the destination.
+ *
+ * @return int
+ *   Returns 1 on success; otherwise, 0.
+ */
+int json_sax_unescape(char *destination, const char *characters, size_t length, int flags, size_t *written_length);
+
+#endif /* JSON_SAX_H */
+
+#ifndef JSON_PARSER_H
+#define JSON_PARSER_H
+
+/**
+ * The data struct definition for an incremental JSON parser.
+ *
+ * A parser is fed the chunks of a JSON stream as they arrive and keeps its
+ * state across chunk boundaries, including inside strings and numbers. The
+ * stream may hold several JSON values back to back.
+ */
+struct json_parser;
+
+/**
+ * Creates an incremental parser reporting the stream values to callbacks.
+ *
+ * Keys and strings given to the callbacks are only valid during the call.
+ *
+ * @param const struct json_decode_options* options
+ *   The decoding options, or NULL to use the defaults. JSON_DECODE_ZERO_COPY
+ *   is ignored.
+ * @param const struct json_sax_handler* handler
+ *   The callbacks.
+ * @param void* context
+ *   The context passed to every callback.
+ *
+ * @return struct json_parser*
+ *   The pointer to the parser, otherwise NULL.
+ */
+struct json_parser *json_parser_create(const struct json_decode_options *options, const struct json_sax_handler *handler, void *context);
+
+/**
+ * Creates an incremental parser decoding the stream values into JSON objects.
+ *
+ * @param const struct json_decode_options* options
+ *   The decoding options, or NULL to use the defaults. JSON_DECODE_ZERO_COPY
+ *   is ignored.
+ * @param int (*on_json)(void *context, struct json *object)
+ *   Called with every complete JSON object, which must be freed by the callee
+ *   with json_destroy(). Returns 1 to continue parsing or 0 to stop it.
+ * @param void* context
+ *   The context passed to the callback.
+ *
+ * @return struct json_parser*
+ *   The pointer to the parser, otherwise NULL.
+ */
+struct json_parser *json_parser_create_tree(const struct json_decode_options *options, int (*on_json)(void *context, struct json *object), void *context);
+
+/**
+ * Feeds the next chunk of the stream to the parser.
+ *
+ * The chunk is parsed in place; only a token cut off by its end is copied,
+ * along with the characters of the next chunk that complete it.
+ *
+ * @param struct json_parser* parser
+ *   The parser instance.
+ * @param const char* buffer
+ *   The chunk characters.
+ * @param size_t length
+ *   The number of characters in the chunk.
+ *
+ * @return int
+ *   Returns 1 when the chunk was consumed; otherwise, 0 on syntax errors or
+ *   when a callback stopped the parsing. A failed parser rejects every
+ *   following chunk.
+ */
+int json_parser_feed(struct json_parser *parser, const char *buffer, size_t length);
+
+/**
+ * Signals the end of the stream.
+ *
+ * A number ending the stream is only complete once the end is known.
+ *
+ * @param struct json_parser* parser
+ *   The parser instance.
+ *
+ * @return int
+ *   Returns 1 when the stream ended between two values; otherwise, 0.
+ */
+int json_parser_finish(struct json_parser *parser);
+
+/**
+ * Frees the parser, including any partially decoded JSON object.
+ *
+ * @param struct json_parser* parser
+ *   The parser instance.
+ */
+void json_parser_free(struct json_parser *parser);
+
+#endif /* JSON_PARSER_H */
+
+#ifndef JSON_LINES_H
+#define JSON_LINES_H
+
+/**
+ * The options that control how newline-delimited JSON records are decoded.
+ */
+struct json_lines_options {
+
+  /**
+   * The number of threads decoding records, including the calling thread.
+   *
+   * Use 0 to select the number of online processors.
+   *
+   * @var size_t threads.
+   */
+  size_t threads;
+
+  /**
+   * The options used to decode every record.
+   *
+   * @var struct json_decode_options decode.
+   */
+  struct json_decode_options decode;
+};
+
+/**
+ * Decodes a buffer of newline-delimited JSON records (NDJSON / JSON Lines).
+ *
+ * The buffer is split on line boundaries into batches that are decoded in
+ * parallel by a pool of worker threads, each owning the arena its records are
+ * allocated from. Records are then reported to the callback from the calling
+ * thread, in input order. Blank lines are skipped.
+ *
+ * @param const char* buffer
+ *   The newline-delimited JSON records. It does not need to be NUL terminated.
+ * @param size_t length
+ *   The number of characters in the buffer.
+ * @param const struct json_lines_options* options
+ *   The decoding options, or NULL to use the defaults.
+ * @param int (*on_record)(void *context, size_t line, struct json *record)
+ *   Called with the zero-based line number and the decoded record of every
+ *   non-blank line, or with NULL when the line is not a valid JSON value. The
+ *   record is owned by the worker arena and only valid during the call.
+ *   Returns 1 to continue or 0 to stop.
+ * @param void* context
+ *   The context passed to the callback.
+ *
+ * @return int
+ *   Returns 1 when every record was reported; otherwise, 0.
+ */
+int json_decode_lines(const char *buffer, size_t length, const struct json_lines_options *options, int (*on_record)(void *context, size_t line, struct json *record), void *context);
+
+/**
+ * Reads the given newline-delimited JSON file and decodes its records.
+ *
+ * The file is memory mapped and decoded in place with json_decode_lines().
+ *
+ * @param const char* filepath
+ *   The filepath with the records.
+ * @param const struct json_lines_options* options
+ *   The decoding options, or NULL to use the defaults.
+ * @param int (*on_record)(void *context, size_t line, struct json *record)
+ *   The callback, as for json_decode_lines().
+ * @param void* context
+ *   The context passed to the callback.
+ *
+ * @return int
+ *   Returns 1 when every record was reported; otherwise, 0.
+ */
+int json_open_lines(const char *filepath, const struct json_lines_options *options, int (*on_record)(void *context, size_t line, struct json *record), void *context);
+
+#endif /* JSON_LINES_H */
@@ -0,0 +1,130 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "allocator.h"
+
+/**
+ * Allocates memory with malloc().
+ *
+ * @param void* context
+ *   Unused.
+ * @param size_t size
+ *   The number of bytes to allocate.
+ *
+ * @return void*
+ *   The pointer to the allocated memory, otherwise NULL.
+ */
+static void *_allocator_malloc(void *context, size_t size) {
+  (void)context;
+  return malloc(size);
+}
+
+/**
+ * Resizes memory with realloc().
+ *
+ * @param void* context
+ *   Unused.
+ * @param void* pointer
+ *   The memory to resize.
+ * @param size_t size
+ *   The new size in bytes.
+ *
+ * @return void*
+ *   The pointer to the resized memory, otherwise NULL.
+ */
+static void *_allocator_realloc(void *context, void *pointer, size_t size) {
+  (void)context;
+  return realloc(pointer, size);
+}
+
+/**
+ * Releases memory with free().
+ *
+ * @param void* context
+ *   Unused.
+ * @param void* pointer
+ *   The memory to release.
+ */
+static void _allocator_free(void *context, void *pointer) {
+  (void)context;
+  free(pointer);
+}
+
+/**
+ * The allocator used when none is given, backed by the C library.
+ */
+static struct json_allocator _allocator_default = {_allocator_malloc, _allocator_realloc, _allocator_free, NULL};
+
+/**
+ * {@inheritdoc}
+ */
+void *_json_alloc(const struct json_allocator *allocator, size_t size) {
+  if (allocator == NULL) {
+    allocator = &_allocator_default;
+  }
+  return allocator->alloc(allocator->context, size);
+}
+
+/**
+ * {@inheritdoc}
+ */
+void *_json_calloc(const struct json_allocator *allocator, size_t count, size_t size) {
+  if (size != 0 && count > SIZE_MAX / size) {
+    return NULL;
+  }
+  void *pointer = _json_alloc(allocator, count * size);
+  if (pointer != NULL) {
+    memset(pointer, 0, count * size);
+  }
+  return pointer;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void *_json_realloc(const struct json_allocator *allocator, void *pointer, size_t size) {
+  if (allocator == NULL) {
+    allocator = &_allocator_default;
+  }
+  return allocator->realloc(allocator->context, pointer, size);
+}
+
+/**
+ * {@inheritdoc}
+ */
+void _json_free(const struct json_allocator *allocator, void *pointer) {
+  if (pointer == NULL) {
+    return;
+  }
+  if (allocator == NULL) {
+    allocator = &_allocator_default;
+  }
+  allocator->free(allocator->context, pointer);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int json_set_allocator(const struct json_allocator *allocator) {
+  if (allocator != NULL && (allocator->alloc == NULL || allocator->realloc == NULL || allocator->free == NULL)) {
+    return 0;
+  }
+  // The blocks cached by the calling thread belong to the previous allocator.
+  json_pool_trim();
+  if (allocator == NULL) {
+    _allocator_default.alloc = _allocator_malloc;
+    _allocator_default.realloc = _allocator_realloc;
+    _allocator_default.free = _allocator_free;
+    _allocator_default.context = NULL;
+  } else {
+    _allocator_default = *allocator;
+  }
+  return 1;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void json_free(void *pointer) {
+  _json_free(NULL, pointer);
+}
@@ -0,0 +1,62 @@
+#ifndef JSON_ALLOCATOR_H
+#define JSON_ALLOCATOR_H
+
+#include <stddef.h>
+#include "../include/json.h"
+
+/**
+ * Allocates memory with the given allocator.
+ *
+ * @param const struct json_allocator* allocator
+ *   The allocator, or NULL for the default allocator.
+ * @param size_t size
+ *   The number of bytes to allocate.
+ *
+ * @return void*
+ *   The pointer to the allocated memory, otherwise NULL.
+ */
+void *_json_alloc(const struct json_allocator *allocator, size_t size);
+
+/**
+ * Allocates zeroed memory for an array with the given allocator.
+ *
+ * @param const struct json_allocator* allocator
+ *   The allocator, or NULL for the default allocator.
+ * @param size_t count
+ *   The number of elements.
+ * @param size_t size
+ *   The size in bytes of every element.
+ *
+ * @return void*
+ *   The pointer to the allocated memory, otherwise NULL (including when the
+ *   total size overflows).
+ */
+void *_json_calloc(const struct json_allocator *allocator, size_t count, size_t size);
+
+/**
+ * Resizes memory allocated with the given allocator.
+ *
+ * @param const struct json_allocator* allocator
+ *   The allocator, or NULL for the default allocator.
+ * @param void* pointer
+ *   The memory to resize, or NULL to allocate.
+ * @param size_t size
+ *   The new size in bytes.
+ *
+ * @return void*
+ *   The pointer to the resized memory, otherwise NULL, in which case the
+ *   given memory is left untouched.
+ */
+void *_json_realloc(const struct json_allocator *allocator, void *pointer, size_t size);
+
+/**
+ * Releases memory allocated with the given allocator.
+ *
+ * @param const struct json_allocator* allocator
+ *   The allocator, or NULL for the default allocator.
+ * @param void* pointer
+ *   The memory to release. May be NULL.
+ */
+void _json_free(const struct json_allocator *allocator, void *pointer);
+
+#endif /* JSON_ALLOCATOR_H */
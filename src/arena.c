@@ -0,0 +1,123 @@
+#include <stdlib.h>
+#include <string.h>
+#include "allocator.h"
+#include "arena.h"
+
+/**
+ * Rounds the given size up to the arena alignment.
+ *
+ * @param size_t size
+ *   The size in bytes.
+ *
+ * @return size_t
+ *   The aligned size in bytes.
+ */
+static size_t _arena_align(size_t size) {
+  const size_t alignment = _Alignof(max_align_t);
+  return (size + alignment - 1) & ~(alignment - 1);
+}
+
+/**
+ * Reserves a new block large enough to serve the given allocation size.
+ *
+ * @param struct json_arena* arena
+ *   The arena instance.
+ * @param size_t size
+ *   The aligned size in bytes of the allocation being served.
+ *
+ * @return struct json_arena_block*
+ *   The pointer to the new block, otherwise NULL.
+ */
+static struct json_arena_block *_arena_grow(struct json_arena *arena, size_t size) {
+  // Grow geometrically so that large documents only need a few blocks.
+  size_t block_size = arena->block_size;
+  if (block_size < size) {
+    block_size = _arena_align(size);
+  }
+  struct json_arena_block *block = (struct json_arena_block *)_json_alloc(arena->allocator, sizeof(struct json_arena_block) + block_size);
+  if (block == NULL) {
+    return NULL;
+  }
+  block->next = arena->head;
+  block->size = block_size;
+  block->used = 0;
+  arena->head = block;
+  // Compute the size of the next block.
+  if (arena->block_size < JSON_ARENA_MAX_BLOCK_SIZE) {
+    arena->block_size *= 2;
+  }
+  return block;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void _arena_init(struct json_arena *arena, const struct json_allocator *allocator) {
+  arena->head = NULL;
+  arena->block_size = JSON_ARENA_BLOCK_SIZE;
+  arena->allocator = allocator;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void *_arena_alloc(struct json_arena *arena, size_t size) {
+  size = _arena_align(size);
+  struct json_arena_block *block = arena->head;
+  // Reserve a new block when the current one cannot serve the allocation.
+  if (block == NULL || block->size - block->used < size) {
+    block = _arena_grow(arena, size);
+    if (block == NULL) {
+      return NULL;
+    }
+  }
+  // Bump the block cursor.
+  void *pointer = (char *)block->data + block->used;
+  block->used += size;
+  return pointer;
+}
+
+/**
+ * {@inheritdoc}
+ */
+char *_arena_strndup(struct json_arena *arena, const char *string, size_t length) {
+  char *copy = (char *)_arena_alloc(arena, length + 1);
+  if (copy == NULL) {
+    return NULL;
+  }
+  memcpy(copy, string, length);
+  copy[length] = '\0';
+  return copy;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void _arena_reset(struct json_arena *arena) {
+  struct json_arena_block *block = arena->head;
+  if (block == NULL) {
+    return;
+  }
+  // Free every block but the latest, which is also the largest one.
+  struct json_arena_block *previous = block->next;
+  while (previous != NULL) {
+    struct json_arena_block *next = previous->next;
+    _json_free(arena->allocator, previous);
+    previous = next;
+  }
+  block->next = NULL;
+  block->used = 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void _arena_release(struct json_arena *arena) {
+  struct json_arena_block *block = arena->head;
+  while (block != NULL) {
+    struct json_arena_block *next = block->next;
+    _json_free(arena->allocator, block);
+    block = next;
+  }
+  _arena_init(arena, arena->allocator);
+}
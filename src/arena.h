@@ -0,0 +1,142 @@
+#ifndef JSON_ARENA_H
+#define JSON_ARENA_H
+
+#include <stddef.h>
+#include "../include/json.h"
+
+/**
+ * The default size in bytes of the first block reserved by an arena.
+ */
+#define JSON_ARENA_BLOCK_SIZE 65536
+
+/**
+ * The upper bound in bytes for the size of the blocks reserved by an arena.
+ *
+ * Blocks double in size until they reach this limit, so a large document only
+ * needs a handful of blocks (and therefore a handful of free calls).
+ */
+#define JSON_ARENA_MAX_BLOCK_SIZE 16777216
+
+/**
+ * The data struct definition for a single memory block owned by an arena.
+ */
+struct json_arena_block {
+
+  /**
+   * Pointer to the previously reserved block.
+   *
+   * @var struct json_arena_block* next.
+   */
+  struct json_arena_block *next;
+
+  /**
+   * The number of usable bytes in the block.
+   *
+   * @var size_t size.
+   */
+  size_t size;
+
+  /**
+   * The number of bytes already handed out from the block.
+   *
+   * @var size_t used.
+   */
+  size_t used;
+
+  /**
+   * The block memory.
+   *
+   * @var max_align_t[] data.
+   */
+  max_align_t data[];
+};
+
+/**
+ * The data struct definition for a bump allocator.
+ *
+ * Memory is carved sequentially out of large blocks and is never released
+ * individually; the whole arena is released at once.
+ */
+struct json_arena {
+
+  /**
+   * Pointer to the block currently used to serve allocations.
+   *
+   * @var struct json_arena_block* head.
+   */
+  struct json_arena_block *head;
+
+  /**
+   * The size in bytes of the next block to reserve.
+   *
+   * @var size_t block_size.
+   */
+  size_t block_size;
+
+  /**
+   * The allocator of the blocks, or NULL for the default allocator.
+   *
+   * @var const struct json_allocator* allocator.
+   */
+  const struct json_allocator *allocator;
+};
+
+/**
+ * Initializes an empty arena.
+ *
+ * No memory is reserved until the first allocation.
+ *
+ * @param struct json_arena* arena
+ *   The arena instance.
+ * @param const struct json_allocator* allocator
+ *   The allocator of the blocks, or NULL for the default allocator.
+ */
+void _arena_init(struct json_arena *arena, const struct json_allocator *allocator);
+
+/**
+ * Allocates memory from the given arena.
+ *
+ * The returned memory is suitably aligned for any type.
+ *
+ * @param struct json_arena* arena
+ *   The arena instance.
+ * @param size_t size
+ *   The number of bytes to allocate.
+ *
+ * @return void*
+ *   The pointer to the allocated memory, otherwise NULL.
+ */
+void *_arena_alloc(struct json_arena *arena, size_t size);
+
+/**
+ * Copies the given characters into a NUL terminated string owned by the arena.
+ *
+ * @param struct json_arena* arena
+ *   The arena instance.
+ * @param const char* string
+ *   The characters to copy.
+ * @param size_t length
+ *   The number of characters to copy.
+ *
+ * @return char*
+ *   The pointer to the copied string, otherwise NULL.
+ */
+char *_arena_strndup(struct json_arena *arena, const char *string, size_t length);
+
+/**
+ * Releases every allocation of the arena but keeps its latest block for reuse.
+ *
+ * @param struct json_arena* arena
+ *   The arena instance.
+ */
+void _arena_reset(struct json_arena *arena);
+
+/**
+ * Releases all the memory owned by the arena.
+ *
+ * @param struct json_arena* arena
+ *   The arena instance.
+ */
+void _arena_release(struct json_arena *arena);
+
+#endif /* JSON_ARENA_H */
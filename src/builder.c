@@ -1,22 +1,32 @@
 #include <stdlib.h>
 #include <string.h>
-#include <strutils.h>
+#include "index.h"
+#include "node.h"
+#include "number.h"
+#include "vector.h"
 #include "../include/json.h"
 
 /**
  * {@inheritdoc}
  */
 struct json *json_string(const char *string) {
-  // Duplicate the string value.
-  char *value = strdup(string);
-  if (value == NULL) {
+  struct json *object = json_create(JSON_string, NULL);
+  if (object == NULL) {
     return NULL;
   }
-  struct json *object = json_create(JSON_string, value);
-  if (object == NULL) {
-    free(value);
+  // Short strings are stored inline.
+  size_t length = strlen(string);
+  if (_json_inline_string(object, string, length) == 1) {
+    return object;
+  }
+  // Copy the string value.
+  char *value = _json_alloc_string(object, length, JSON_FLAG_VALUE_POOLED);
+  if (value == NULL) {
+    json_destroy(object);
     return NULL;
   }
+  memcpy(value, string, length + 1);
+  object->value = value;
   return object;
 }
 
@@ -25,47 +35,50 @@ struct json *json_string(const char *string) {
  */
 struct json *json_number(const double number) {
   // Build the JSON double instance.
-  size_t size = sizeof(double);
-  double *value = (double *)malloc(size);
-  *value = number;
-  struct json *object = json_create(JSON_number, value);
+  struct json *object = json_create(JSON_number, NULL);
   if (object == NULL) {
-    free(value);
     return NULL;
   }
+  object->scalar.number = number;
   return object;
 }
 
 /**
  * {@inheritdoc}
  */
-struct json *json_number_string(const double number) {
-  // Convert the number to a string representation.
-  char *value = ldtos(number);
-  if (value == NULL) {
-    return NULL;
-  }
-  // Create a JSON object with the string representation of the number.
-  struct json *object = json_create(JSON_string, value);
+struct json *json_integer(const int64_t integer) {
+  // Build the JSON integer instance.
+  struct json *object = json_create(JSON_number, NULL);
   if (object == NULL) {
-    free(value);
     return NULL;
   }
+  object->flags |= JSON_FLAG_INTEGER;
+  object->scalar.integer.number = (double)integer;
+  object->scalar.integer.value = integer;
   return object;
 }
 
+/**
+ * {@inheritdoc}
+ */
+struct json *json_number_string(const double number) {
+  // Convert the number to its shortest string representation.
+  char value[JSON_NUMBER_BUFFER_SIZE];
+  _json_format_double(number, value);
+  // Create a JSON object with the string representation of the number.
+  return json_string(value);
+}
+
 /**
  * {@inheritdoc}
  */
 struct json *json_bool(const int bool_value) {
   // Build the JSON boolean instance.
-  int *value = (int *)malloc(sizeof(int));
-  *value = bool_value;
-  struct json *object = json_create(JSON_boolean, value);
+  struct json *object = json_create(JSON_boolean, NULL);
   if (object == NULL) {
-    free(value);
     return NULL;
   }
+  object->scalar.boolean = bool_value;
   return object;
 }
 
@@ -98,12 +111,20 @@ struct json *json_object(const char *key, void *value) {
   if (object == NULL) {
     return NULL;
   }
-  char *object_key = strdup(key);
+  const size_t key_length = strlen(key);
+  char *object_key = _json_alloc_string(object, key_length, JSON_FLAG_KEY_POOLED);
   if (object_key == NULL) {
+    json_destroy(object);
     return NULL;
   }
+  memcpy(object_key, key, key_length + 1);
   object->key = object_key;
+  object->key_length = key_length;
   object->value = value;
+  // The tail and the number of children of the given chain are found on the first push.
+  if (value != NULL) {
+    object->scalar.children.state = JSON_CHILDREN_UNKNOWN;
+  }
   return object;
 }
 
@@ -119,7 +140,7 @@ struct json *json_object_string(const char *key, const char *string) {
   // Add the JSON string value.
   object->value = json_string(string);
   if (object->value == NULL) {
-    free(object);
+    json_destroy(object);
     return NULL;
   }
   return object;
@@ -137,7 +158,7 @@ struct json *json_object_number(const char *key, const double number) {
   // Add the JSON number value.
   object->value = json_number(number);
   if (object->value == NULL) {
-    free(object);
+    json_destroy(object);
     return NULL;
   }
   return object;
@@ -146,20 +167,95 @@ struct json *json_object_number(const char *key, const double number) {
 /**
  * {@inheritdoc}
  */
-struct json *json_object_number_string(const char *key, const double number) {
-  // Convert the number to a string representation.
-  char *value_string = ldtos(number);
-  if (value_string == NULL) {
+struct json *json_object_integer(const char *key, const int64_t integer) {
+  // Build the JSON object.
+  struct json *object = json_object(key, NULL);
+  if (object == NULL) {
     return NULL;
   }
+  // Add the JSON integer value.
+  object->value = json_integer(integer);
+  if (object->value == NULL) {
+    json_destroy(object);
+    return NULL;
+  }
+  return object;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct json *json_object_number_string(const char *key, const double number) {
+  // Convert the number to its shortest string representation.
+  char value_string[JSON_NUMBER_BUFFER_SIZE];
+  _json_format_double(number, value_string);
   // Create a JSON string object instance.
   return json_object_string(key, value_string);
 }
 
+/**
+ * Counts a child appended to a container.
+ *
+ * @param struct json* container
+ *   The JSON object or array.
+ * @param struct json* child
+ *   The child, already linked at the end of the container.
+ */
+static void _builder_count_child(struct json *container, struct json *child) {
+  // The key index of large objects and the element vector of long arrays hold the count.
+  if (_json_children_extension(container) == NULL) {
+    _json_children_set_count(container, _json_children_count(container) + 1);
+  } else if (container->type == JSON_object) {
+    _json_index_insert(container, child);
+  } else {
+    _json_vector_push(container, child);
+  }
+}
+
+/**
+ * Appends a chain of children to a container in constant time.
+ *
+ * @param struct json* container
+ *   The JSON object or array.
+ * @param struct json* first
+ *   The first child of the chain.
+ */
+static void _builder_append(struct json *container, struct json *first) {
+  if (container->value == NULL) {
+    container->value = first;
+  } else {
+    // The tail is only unknown for chains given up front, which are walked once.
+    struct json *tail = container->scalar.children.tail;
+    if (tail == NULL) {
+      size_t count = 1;
+      for (tail = (struct json *)container->value; tail->next != NULL; tail = tail->next) {
+        count++;
+      }
+      if (_json_children_extension(container) == NULL) {
+        _json_children_set_count(container, count);
+      }
+    }
+    tail->next = first;
+    first->prev = tail;
+  }
+  // Count every child of the chain and make the last one the tail.
+  struct json *last = first;
+  _builder_count_child(container, last);
+  while (last->next != NULL) {
+    last = last->next;
+    _builder_count_child(container, last);
+  }
+  container->scalar.children.tail = last;
+}
+
 /**
  * {@inheritdoc}
  */
 void json_push(struct json *container, struct json *child) {
+  if (container->type == JSON_object || container->type == JSON_array) {
+    _builder_append(container, child);
+    return;
+  }
   if (container->value == NULL) {
     container->value = child;
     return;
@@ -175,6 +271,44 @@ void json_push(struct json *container, struct json *child) {
   child->prev = iterator;
 }
 
+/**
+ * {@inheritdoc}
+ */
+int json_remove(struct json *container, const char *key) {
+  if (container == NULL || key == NULL || container->type != JSON_object) {
+    return 0;
+  }
+  // Find the member, through the key index of large objects.
+  struct json *member = _json_index_find(container, key, strlen(key));
+  if (member == NULL) {
+    return 0;
+  }
+  if (_json_children_extension(container) == NULL) {
+    _json_children_set_count(container, _json_children_count(container) - 1);
+  } else {
+    _json_index_remove(container, member);
+  }
+  // Unlink the member from the sibling list.
+  if (container->scalar.children.tail == member) {
+    container->scalar.children.tail = member->prev;
+  }
+  if (member->prev != NULL) {
+    member->prev->next = member->next;
+  } else {
+    container->value = member->next;
+  }
+  if (member->next != NULL) {
+    member->next->prev = member->prev;
+  }
+  member->next = NULL;
+  member->prev = NULL;
+  // Members carved from a document arena are released with the document.
+  if ((member->flags & JSON_FLAG_ARENA) == 0) {
+    json_destroy(member);
+  }
+  return 1;
+}
+
 /**
  * {@inheritdoc}
  */
@@ -182,11 +316,21 @@ int json_push_multiple(struct json *container, struct json **items, int size) {
   if (container == NULL || items == NULL) {
     return 1;
   }
-  for (int i = 0; i < size; ++i) {
-    if (items[i] == NULL) {
-      return 1;
+  // Link the items up to the first missing one, then append them at once.
+  int count = 0;
+  while (count < size && items[count] != NULL) {
+    if (count > 0) {
+      struct json *last = items[count - 1];
+      while (last->next != NULL) {
+        last = last->next;
+      }
+      last->next = items[count];
+      items[count]->prev = last;
     }
-    json_push(container, items[i]);
+    count++;
+  }
+  if (count > 0) {
+    json_push(container, items[0]);
   }
-  return 0;
+  return count < size ? 1 : 0;
 }
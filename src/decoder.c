@@ -1,238 +1,1085 @@
-#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "allocator.h"
 #include "decoder.h"
+#include "escape.h"
+#include "index.h"
+#include "node.h"
+#include "number.h"
+#include "vector.h"
 
 /**
- * {@inheritdoc}
+ * Allocates memory for a decoded value.
+ *
+ * @param struct json_decoder* decoder
+ *   The decoder instance.
+ * @param size_t size
+ *   The number of bytes to allocate.
+ *
+ * @return void*
+ *   The pointer to the allocated memory, otherwise NULL.
+ */
+static void *_decoder_alloc(struct json_decoder *decoder, size_t size) {
+  if (decoder->arena != NULL) {
+    return _arena_alloc(decoder->arena, size);
+  }
+  return _json_alloc(NULL, size);
+}
+
+/**
+ * Allocates the buffer of a decoded key or string.
+ *
+ * @param struct json_decoder* decoder
+ *   The decoder instance.
+ * @param struct json* object
+ *   The JSON node the buffer belongs to.
+ * @param size_t length
+ *   The number of characters, not counting the NUL terminator.
+ * @param unsigned int flag
+ *   JSON_FLAG_KEY_POOLED or JSON_FLAG_VALUE_POOLED.
+ *
+ * @return char*
+ *   The pointer to the allocated memory, otherwise NULL.
+ */
+static char *_decoder_alloc_string(struct json_decoder *decoder, struct json *object, size_t length, unsigned int flag) {
+  if (decoder->arena != NULL) {
+    return (char *)_arena_alloc(decoder->arena, length + 1);
+  }
+  return _json_alloc_string(object, length, flag);
+}
+
+/**
+ * Creates a new JSON node for a decoded value.
+ *
+ * @param struct json_decoder* decoder
+ *   The decoder instance.
+ * @param enum JSONDataType type
+ *   The Supported JSON Data Type.
+ * @param void* value
+ *   The pointer value.
+ *
+ * @return struct json*
+ *   The pointer to the json instance, otherwise NULL.
+ */
+static struct json *_decoder_create(struct json_decoder *decoder, enum JSONDataType type, void *value) {
+  if (decoder->arena == NULL) {
+    return json_create(type, value);
+  }
+  struct json *json_object = (struct json *)_arena_alloc(decoder->arena, sizeof(struct json));
+  if (json_object == NULL) {
+    return NULL;
+  }
+  _json_init(json_object, type, value);
+  json_object->flags |= JSON_FLAG_ARENA;
+  return json_object;
+}
+
+/**
+ * Destroys a partially decoded JSON node chain.
+ *
+ * @param struct json_decoder* decoder
+ *   The decoder instance.
+ * @param struct json* object
+ *   The JSON object to be cleaned.
+ */
+static void _decoder_destroy(struct json_decoder *decoder, struct json *object) {
+  if (decoder->arena == NULL) {
+    json_destroy(object);
+  }
+}
+
+/**
+ * Finds the bounds of the double-quoted string at the current token.
+ *
+ * The decoder is left on the closing double quote.
+ *
+ * @param struct json_decoder* decoder
+ *   The decoder instance.
+ * @param size_t* length
+ *   Receives the number of characters between the double quotes.
+ *
+ * @return const char*
+ *   The pointer to the first character after the opening double quote, otherwise NULL.
+ */
+static const char *_decoder_scan_string(struct json_decoder *decoder, size_t *length) {
+  if (_decoder_current_token(decoder) != '\"') {
+    return NULL;
+  }
+  // Find the closing double quote, skipping escaped double quotes and the
+  // characters scanned before the input was cut off.
+  const size_t start = decoder->position + 1;
+  size_t end = start + decoder->scanned;
+  while (1) {
+    const char *quote = end < decoder->length ? (const char *)memchr(decoder->input + end, '\"', decoder->length - end) : NULL;
+    if (quote == NULL) {
+      // Unterminated string, which may continue in the next input.
+      if (decoder->partial) {
+        decoder->scanned = decoder->length - start;
+      }
+      return NULL;
+    }
+    end = (size_t)(quote - decoder->input);
+    // The double quote is escaped when preceded by an odd number of backslashes.
+    size_t backslashes = 0;
+    while (end - backslashes > start && decoder->input[end - backslashes - 1] == '\\') {
+      backslashes++;
+    }
+    if (backslashes % 2 == 0) {
+      break;
+    }
+    end++;
+  }
+  *length = end - start;
+  decoder->position = end;
+  decoder->scanned = 0;
+  return decoder->input + start;
+}
+
+/**
+ * Validates the characters of a string in strict mode, unless the handler validates them itself.
+ *
+ * @param struct json_decoder* decoder
+ *   The decoder instance.
+ * @param const char* start
+ *   The first character of the string in the input.
+ * @param size_t length
+ *   The number of characters in the string.
+ *
+ * @return int
+ *   Returns 1 when the string is valid or needs no validation; otherwise, 0.
+ */
+static int _decoder_check_string(struct json_decoder *decoder, const char *start, size_t length) {
+  if ((decoder->flags & JSON_DECODE_STRICT) == 0 || decoder->handler_validates) {
+    return 1;
+  }
+  size_t validated = 0;
+  return _json_unescape_string(NULL, start, length, 1, &validated);
+}
+
+/**
+ * Creates a JSON string node that references the given input characters.
+ *
+ * Strings with escape sequences get a buffer reserved for their lazy
+ * materialization.
+ *
+ * @param struct json_decoder* decoder
+ *   The decoder instance.
+ * @param const char* start
+ *   The first character of the string in the input.
+ * @param size_t length
+ *   The number of characters in the string.
+ *
+ * @return struct json*
+ *   The pointer to the json instance, otherwise NULL.
+ */
+static struct json *_decoder_create_view(struct json_decoder *decoder, const char *start, size_t length) {
+  struct json *json_object = _decoder_create(decoder, JSON_string, (void *)start);
+  if (json_object == NULL) {
+    return NULL;
+  }
+  json_object->flags |= JSON_FLAG_VALUE_VIEW;
+  json_object->scalar.view.length = length;
+  json_object->scalar.view.text = NULL;
+  if (memchr(start, '\\', length) == NULL) {
+    return json_object;
+  }
+  // Reserve the buffer used to materialize the escaped string.
+  json_object->scalar.view.text = (char *)_decoder_alloc(decoder, length + 1);
+  if (json_object->scalar.view.text == NULL) {
+    _decoder_destroy(decoder, json_object);
+    return NULL;
+  }
+  json_object->flags |= JSON_FLAG_VALUE_ESCAPED;
+  return json_object;
+}
+
+/**
+ * Checks whether the given literal starts at the current token.
+ *
+ * When found, the decoder is left on the last character of the literal.
+ *
+ * @param struct json_decoder* decoder
+ *   The decoder instance.
+ * @param const char* literal
+ *   The literal to search for.
+ *
+ * @return int
+ *   Returns 1 when the literal was found, -1 when the input ends with a prefix
+ *   of the literal and may continue; otherwise, 0.
+ */
+static int _decoder_match_literal(struct json_decoder *decoder, const char *literal) {
+  size_t length = strlen(literal);
+  const size_t available = decoder->length - decoder->position;
+  if (available < length) {
+    const int prefix = memcmp(decoder->input + decoder->position, literal, available) == 0;
+    return decoder->partial && prefix ? -1 : 0;
+  }
+  if (memcmp(decoder->input + decoder->position, literal, length) != 0) {
+    return 0;
+  }
+  decoder->position += length - 1;
+  return 1;
+}
+
+/**
+ * Moves the decoder past any whitespace at the current position.
+ *
+ * @param struct json_decoder* decoder
+ *   The decoder instance.
+ */
+static void _decoder_skip_whitespaces(struct json_decoder *decoder) {
+  while (decoder->position < decoder->length) {
+    const char token = decoder->input[decoder->position];
+    if (token != ' ' && token != '\t' && token != '\n' && token != '\r') {
+      break;
+    }
+    decoder->position++;
+  }
+}
+
+/**
+ * Opens a new container frame on the decoder stack.
+ *
+ * @param struct json_decoder* decoder
+ *   The decoder instance.
+ * @param int is_object
+ *   Whether the container is an object (1) or an array (0).
+ *
+ * @return int
+ *   Returns 1 when the frame was pushed; otherwise, 0.
+ */
+static int _decoder_push_frame(struct json_decoder *decoder, int is_object) {
+  if (decoder->depth >= decoder->max_depth) {
+    // Maximum nesting depth exceeded.
+    return 0;
+  }
+  // Grow the stack when it is full.
+  if (decoder->depth == decoder->capacity) {
+    size_t capacity = decoder->capacity == 0 ? 32 : decoder->capacity * 2;
+    struct json_decoder_frame *frames = (struct json_decoder_frame *)_json_realloc(decoder->allocator, decoder->frames, capacity * sizeof(struct json_decoder_frame));
+    if (frames == NULL) {
+      return 0;
+    }
+    decoder->frames = frames;
+    decoder->capacity = capacity;
+  }
+  decoder->frames[decoder->depth].is_object = is_object;
+  decoder->frames[decoder->depth].container = NULL;
+  decoder->frames[decoder->depth].tail = NULL;
+  decoder->frames[decoder->depth].count = 0;
+  decoder->depth++;
+  return 1;
+}
+
+/**
+ * Extracts the number at the current token.
+ *
+ * The decoder is left on the last character of the number.
+ *
+ * @param struct json_decoder* decoder
+ *   The decoder instance.
+ * @param struct json_number_token* number
+ *   Receives the number value.
+ *
+ * @return int
+ *   Returns 1 when a number was extracted, -1 when the number reaches the end
+ *   of an input that may continue; otherwise, 0.
  */
-struct json *_decode_json(struct StringTokenizer *tokenizer) {
-  // Get the current token in the tokenizer.
-  const char token = st_current_token(tokenizer);
-  // Decodes the token based on the different types of JSON values.
-  // Check for object token.
-  if (token == '{') {
-    return _decode_json_object(tokenizer);
+static int _decoder_scan_number(struct json_decoder *decoder, struct json_number_token *number) {
+  // Parse the number, without reading past the input.
+  size_t consumed = 0;
+  const int status = _json_parse_number(decoder->input + decoder->position, decoder->length - decoder->position, &consumed, number);
+  if (decoder->partial && decoder->position + consumed == decoder->length) {
+    return -1;
   }
-  // Check for array token.
-  if (token == '[') {
-    return _decode_json_array(tokenizer);
+  if (status == 0) {
+    return 0;
   }
+  // Leave the decoder on the last character of the number.
+  decoder->position += consumed - 1;
+  return 1;
+}
+
+/**
+ * Parses the scalar value at the current token and reports it to the handler.
+ *
+ * The decoder is left on the last character of the value.
+ *
+ * @param struct json_decoder* decoder
+ *   The decoder instance.
+ *
+ * @return int
+ *   Returns 1 when the value was parsed and reported, -1 when the value is cut
+ *   off by the end of an input that may continue; otherwise, 0.
+ */
+static int _decoder_parse_scalar(struct json_decoder *decoder) {
+  const struct json_sax_handler *handler = decoder->handler;
+  void *context = decoder->context;
+  int status = 0;
+  // Get the current token in the decoder.
+  const char token = _decoder_current_token(decoder);
   // Check for string double-quote token.
   if (token == '\"') {
-    return _decode_json_string(tokenizer);
+    size_t length = 0;
+    const char *start = _decoder_scan_string(decoder, &length);
+    if (start == NULL) {
+      return decoder->partial ? -1 : 0;
+    }
+    if (_decoder_check_string(decoder, start, length) == 0) {
+      return 0;
+    }
+    return handler->on_string == NULL || handler->on_string(context, start, length) == 1;
   }
   // Check for number token.
-  if (token == '-' || token >= '0' || token <= '9') {
-    return _decode_json_number(tokenizer);
+  if (token == '-' || (token >= '0' && token <= '9')) {
+    struct json_number_token number;
+    status = _decoder_scan_number(decoder, &number);
+    if (status != 1) {
+      return status;
+    }
+    if (number.kind == JSON_NUMBER_INTEGER && handler->on_integer != NULL) {
+      return handler->on_integer(context, number.integer) == 1;
+    }
+    if (number.kind == JSON_NUMBER_UNSIGNED && handler->on_unsigned != NULL) {
+      return handler->on_unsigned(context, (uint64_t)number.integer) == 1;
+    }
+    return handler->on_number == NULL || handler->on_number(context, number.number) == 1;
   }
   // Check for boolean tokens(true or false).
   if (token == 't' || token == 'f') {
-    return _decode_json_boolean(tokenizer);
+    const int bool_value = token == 't';
+    status = _decoder_match_literal(decoder, bool_value ? "true" : "false");
+    if (status != 1) {
+      return status;
+    }
+    return handler->on_boolean == NULL || handler->on_boolean(context, bool_value) == 1;
   }
   // Check for null token.
   if (token == 'n') {
-    return _decode_json_null(tokenizer);
+    status = _decoder_match_literal(decoder, "null");
+    if (status != 1) {
+      return status;
+    }
+    return handler->on_null == NULL || handler->on_null(context) == 1;
   }
   // Invalid JSON token.
-  return NULL;
+  return 0;
 }
 
 /**
- * {@inheritdoc}
+ * Moves the decoder past a complete value.
+ *
+ * @param struct json_decoder* decoder
+ *   The decoder instance.
  */
-struct json *_decode_json_string(struct StringTokenizer *tokenizer) {
-  // Get the substring between the double quotes.
-  char *value = st_sub_string(tokenizer, '\"', '\"');
-  if (value == NULL) {
-    return NULL;
+static void _decoder_end_value(struct json_decoder *decoder) {
+  // Stay on the last character of the root value.
+  if (decoder->depth == 0) {
+    decoder->state = JSON_DECODER_DONE;
+    return;
   }
-  // Init the JSON object instance.
-  struct json *json_object = json_create(JSON_string, value);
-  if (json_object == NULL) {
-    free(value);
+  _decoder_next_token(decoder);
+  decoder->state = JSON_DECODER_NEXT;
+}
+
+/**
+ * Closes the innermost container and reports its end to the handler.
+ *
+ * @param struct json_decoder* decoder
+ *   The decoder instance.
+ *
+ * @return int
+ *   Returns 1 when the container was closed; otherwise, 0.
+ */
+static int _decoder_close_container(struct json_decoder *decoder) {
+  const struct json_sax_handler *handler = decoder->handler;
+  decoder->depth--;
+  if (decoder->frames[decoder->depth].is_object) {
+    if (handler->on_object_end != NULL && handler->on_object_end(decoder->context) == 0) {
+      return 0;
+    }
+  } else if (handler->on_array_end != NULL && handler->on_array_end(decoder->context) == 0) {
+    return 0;
+  }
+  _decoder_end_value(decoder);
+  return 1;
+}
+
+/**
+ * Consumes the current token according to the decoder state.
+ *
+ * @param struct json_decoder* decoder
+ *   The decoder instance.
+ *
+ * @return int
+ *   Returns 1 when the token was consumed, -1 when the token is cut off by the
+ *   end of an input that may continue; otherwise, 0.
+ */
+static int _decoder_step(struct json_decoder *decoder) {
+  const struct json_sax_handler *handler = decoder->handler;
+  // Wait for the next token of inputs that may continue.
+  if (decoder->position >= decoder->length) {
+    return decoder->partial ? -1 : 0;
+  }
+  const char token = _decoder_current_token(decoder);
+  switch (decoder->state) {
+    case JSON_DECODER_COLON:
+      // Check for the colon (:) character.
+      if (token != ':') {
+        return 0;
+      }
+      _decoder_next_token(decoder);
+      decoder->state = JSON_DECODER_VALUE;
+      return 1;
+
+    case JSON_DECODER_NEXT:
+      // Move to the next sibling value.
+      if (token == ',') {
+        _decoder_next_token(decoder);
+        decoder->state = decoder->frames[decoder->depth - 1].is_object ? JSON_DECODER_KEY : JSON_DECODER_VALUE;
+        return 1;
+      }
+      // Check the container closing token.
+      if (token != (decoder->frames[decoder->depth - 1].is_object ? '}' : ']')) {
+        return 0;
+      }
+      return _decoder_close_container(decoder);
+
+    case JSON_DECODER_FIRST_KEY:
+      // Check for an empty object.
+      if (token == '}') {
+        return _decoder_close_container(decoder);
+      }
+      // fall through
+    case JSON_DECODER_KEY: {
+      // Extract the object key.
+      size_t length = 0;
+      const char *key = _decoder_scan_string(decoder, &length);
+      if (key == NULL) {
+        return token == '\"' && decoder->partial ? -1 : 0;
+      }
+      if (_decoder_check_string(decoder, key, length) == 0) {
+        return 0;
+      }
+      if (handler->on_key != NULL && handler->on_key(decoder->context, key, length) == 0) {
+        return 0;
+      }
+      _decoder_next_token(decoder);
+      decoder->state = JSON_DECODER_COLON;
+      return 1;
+    }
+
+    case JSON_DECODER_FIRST_VALUE:
+      // Check for an empty array.
+      if (token == ']') {
+        return _decoder_close_container(decoder);
+      }
+      // fall through
+    case JSON_DECODER_VALUE:
+      // Open a new object or array container.
+      if (token == '{' || token == '[') {
+        const int is_object = token == '{';
+        if (_decoder_push_frame(decoder, is_object) == 0) {
+          return 0;
+        }
+        if (is_object && handler->on_object_start != NULL && handler->on_object_start(decoder->context) == 0) {
+          return 0;
+        }
+        if (!is_object && handler->on_array_start != NULL && handler->on_array_start(decoder->context) == 0) {
+          return 0;
+        }
+        _decoder_next_token(decoder);
+        decoder->state = is_object ? JSON_DECODER_FIRST_KEY : JSON_DECODER_FIRST_VALUE;
+        return 1;
+      }
+      // Parse scalar values in place.
+      const int status = _decoder_parse_scalar(decoder);
+      if (status != 1) {
+        return status;
+      }
+      _decoder_end_value(decoder);
+      return 1;
+
+    default:
+      return 0;
   }
-  // String decoding completed.
-  return json_object;
 }
 
 /**
  * {@inheritdoc}
  */
-struct json *_decode_json_boolean(struct StringTokenizer *tokenizer) {
-  // Get the current token in the tokenizer.
-  const char token = st_current_token(tokenizer);
-  // Declare the bool value as int.
-  int *value = NULL;
-  // Search for boolean true token.
-  if (token == 't') {
-    value = st_extract_boolean(tokenizer, "true", 1);
-  }
-  // Search for boolean false token.
-  else if (token == 'f') {
-    value = st_extract_boolean(tokenizer, "false", 0);
-  } else {
-    // Invalid JSON boolean token.
-    return NULL;
+void _decoder_init(struct json_decoder *decoder, const char *input, size_t length, struct json_arena *arena) {
+  decoder->input = input;
+  decoder->length = length;
+  decoder->position = 0;
+  decoder->arena = arena;
+  decoder->allocator = arena != NULL ? arena->allocator : NULL;
+  decoder->max_depth = JSON_DEFAULT_MAX_DEPTH;
+  decoder->flags = 0;
+  decoder->handler = NULL;
+  decoder->context = NULL;
+  decoder->state = JSON_DECODER_VALUE;
+  decoder->partial = 0;
+  decoder->scanned = 0;
+  decoder->handler_validates = 0;
+  decoder->frames = NULL;
+  decoder->depth = 0;
+  decoder->capacity = 0;
+  _json_structural_index_init(&decoder->index, NULL, 0, decoder->allocator);
+  decoder->index_base = 0;
+  decoder->index_cursor = 0;
+  // Skip the leading whitespaces.
+  _decoder_skip_whitespaces(decoder);
+}
+
+/**
+ * {@inheritdoc}
+ */
+char _decoder_current_token(struct json_decoder *decoder) {
+  if (decoder->position >= decoder->length) {
+    return '\0';
   }
-  // Check the extracted value.
-  if (value == NULL) {
-    return NULL;
+  return decoder->input[decoder->position];
+}
+
+/**
+ * {@inheritdoc}
+ */
+void _decoder_next_token(struct json_decoder *decoder) {
+  if (decoder->position >= decoder->length) {
+    return;
   }
-  // Init the JSON object instance.
-  struct json *json_object = json_create(JSON_boolean, value);
-  if (json_object == NULL) {
-    free(value);
+  // Look the next token up in the structural index.
+  if (decoder->index.input != NULL) {
+    decoder->index_cursor++;
+    // Index the next window once the current one is exhausted.
+    if (decoder->index_cursor >= decoder->index.count) {
+      decoder->index_cursor = 0;
+      if (_json_structural_index_next_window(&decoder->index) == 0) {
+        decoder->position = decoder->length;
+        return;
+      }
+    }
+    decoder->position = decoder->index_base + decoder->index.base + decoder->index.offsets[decoder->index_cursor];
+    return;
+  }
+  // Move past the current token and skip the whitespaces.
+  decoder->position++;
+  _decoder_skip_whitespaces(decoder);
+}
+
+/**
+ * Indexes the token starts of large inputs up front (stage 1), so that the
+ * decoder loop (stage 2) jumps from token to token.
+ *
+ * @param struct json_decoder* decoder
+ *   The decoder instance.
+ */
+static void _decoder_index_input(struct json_decoder *decoder) {
+  _json_structural_index_free(&decoder->index);
+  _json_structural_index_init(&decoder->index, NULL, 0, decoder->allocator);
+  if (decoder->length - decoder->position < JSON_STRUCTURAL_INDEX_MIN_LENGTH) {
+    return;
+  }
+  // Do not index the characters of a cut off string again.
+  if (decoder->scanned > 0) {
+    return;
+  }
+  _json_structural_index_init(&decoder->index, decoder->input + decoder->position, decoder->length - decoder->position, decoder->allocator);
+  if (_json_structural_index_next_window(&decoder->index) == 1) {
+    decoder->index_base = decoder->position;
+    decoder->index_cursor = 0;
+  } else {
+    _json_structural_index_free(&decoder->index);
+    _json_structural_index_init(&decoder->index, NULL, 0, decoder->allocator);
   }
-  // Boolean decoding completed.
-  return json_object;
 }
 
 /**
  * {@inheritdoc}
  */
-struct json *_decode_json_null(struct StringTokenizer *tokenizer) {
-  // Search for the null string.
-  if (st_starts_with(tokenizer, "null") == 0) {
-    // Not a null token.
-    return NULL;
+void _decoder_set_input(struct json_decoder *decoder, const char *input, size_t length) {
+  decoder->input = input;
+  decoder->length = length;
+  decoder->position = 0;
+  _decoder_skip_whitespaces(decoder);
+  _decoder_index_input(decoder);
+}
+
+/**
+ * {@inheritdoc}
+ */
+void _decoder_skip_value(struct json_decoder *decoder) {
+  decoder->position++;
+  _decoder_skip_whitespaces(decoder);
+  _decoder_index_input(decoder);
+  decoder->state = JSON_DECODER_VALUE;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int _decoder_run(struct json_decoder *decoder) {
+  while (decoder->state != JSON_DECODER_DONE) {
+    const int status = _decoder_step(decoder);
+    if (status != 1) {
+      return status;
+    }
   }
-  // NULL decoding completed.
-  return json_create(JSON_null, NULL);
+  return 1;
 }
 
 /**
  * {@inheritdoc}
  */
-struct json *_decode_json_number(struct StringTokenizer *tokenizer) {
-  // Extract double value from string.
-  double *value = st_extract_double(tokenizer);
-  if (value == NULL) {
-    return NULL;
+void _decoder_release(struct json_decoder *decoder) {
+  _json_structural_index_free(&decoder->index);
+  _json_structural_index_init(&decoder->index, NULL, 0, decoder->allocator);
+  _json_free(decoder->allocator, decoder->frames);
+  decoder->frames = NULL;
+  decoder->depth = 0;
+  decoder->capacity = 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int _decoder_parse(struct json_decoder *decoder) {
+  _decoder_index_input(decoder);
+  // Consume tokens until the root value is complete.
+  decoder->state = JSON_DECODER_VALUE;
+  const int status = _decoder_run(decoder) == 1;
+  // Free the decoder stack and index.
+  _decoder_release(decoder);
+  return status;
+}
+
+/**
+ * Links the given value into its enclosing container.
+ *
+ * When no container encloses the value it becomes the decoded root.
+ *
+ * @param struct json_decoder_tree* tree
+ *   The tree building state.
+ * @param struct json* value
+ *   The decoded value.
+ * @param size_t depth
+ *   The number of containers enclosing the value.
+ */
+static void _decoder_tree_attach(struct json_decoder_tree *tree, struct json *value, size_t depth) {
+  if (depth == 0) {
+    tree->root = value;
+    return;
   }
-  // Init the JSON object instance.
-  struct json *json_object = json_create(JSON_number, value);
-  if (json_object == NULL) {
-    free(value);
+  struct json_decoder_frame *frame = &tree->decoder->frames[depth - 1];
+  // Object values belong to the latest key node.
+  if (frame->is_object) {
+    frame->tail->value = value;
+    return;
+  }
+  // Array values are appended to the element chain.
+  if (frame->tail == NULL) {
+    frame->container->value = value;
+  } else {
+    frame->tail->next = value;
+    value->prev = frame->tail;
+  }
+  frame->tail = value;
+  frame->count++;
+}
+
+/**
+ * Creates a JSON node for a scalar value and links it into the tree.
+ *
+ * @param void* context
+ *   The tree building state.
+ * @param enum JSONDataType type
+ *   The Supported JSON Data Type.
+ *
+ * @return struct json*
+ *   The pointer to the json instance, otherwise NULL.
+ */
+static struct json *_decoder_tree_scalar(void *context, enum JSONDataType type) {
+  struct json_decoder_tree *tree = (struct json_decoder_tree *)context;
+  struct json *json_object = _decoder_create(tree->decoder, type, NULL);
+  if (json_object != NULL) {
+    _decoder_tree_attach(tree, json_object, tree->decoder->depth);
   }
-  // Number decoding completed.
   return json_object;
 }
 
 /**
- * {@inheritdoc}
+ * Creates a JSON object or array container and links it into the tree.
+ *
+ * @param void* context
+ *   The tree building state.
+ * @param enum JSONDataType type
+ *   The Supported JSON Data Type.
+ *
+ * @return int
+ *   Returns 1 when the container was created; otherwise, 0.
  */
-struct json *_decode_json_array(struct StringTokenizer *tokenizer) {
-  // Get the current token in the tokenizer.
-  char token = st_current_token(tokenizer);
-  // Check the start of the array.
-  if (token != '[') {
-    // Not an array.
-    return NULL;
+static int _decoder_tree_container(void *context, enum JSONDataType type) {
+  struct json_decoder_tree *tree = (struct json_decoder_tree *)context;
+  struct json_decoder *decoder = tree->decoder;
+  struct json *container = _decoder_create(decoder, type, NULL);
+  if (container == NULL) {
+    return 0;
   }
-  // Loop through the comma separated array elements.
-  struct json *head = NULL, *current = NULL, *prev = NULL;
-  do {
-    // Get the next valid token.
-    st_next_token(tokenizer);
-    token = st_current_token(tokenizer);
-    // Decodes the array value.
-    current = _decode_json(tokenizer);
-    if (current == NULL) {
-      return NULL;
-    }
-    // Get the next valid token.
-    st_next_token(tokenizer);
-    token = st_current_token(tokenizer);
-    // Updates the position of the current element in the linked list.
-    if (head == NULL) {
-      head = current;
-      prev = current;
-    } else {
-      prev->next = current;
-      current->prev = prev;
-      prev = current;
-    }
-  } while (token == ',');
-  // Check the JSON array closing token.
-  if (token != ']') {
-    json_destroy(head);
-    return NULL;
+  // The decoder already pushed the frame of the new container.
+  _decoder_tree_attach(tree, container, decoder->depth - 1);
+  decoder->frames[decoder->depth - 1].container = container;
+  return 1;
+}
+
+/**
+ * Handles the start of an object.
+ *
+ * @param void* context
+ *   The tree building state.
+ *
+ * @return int
+ *   Returns 1 on success; otherwise, 0.
+ */
+static int _decoder_tree_object_start(void *context) {
+  return _decoder_tree_container(context, JSON_object);
+}
+
+/**
+ * Handles the start of an array.
+ *
+ * @param void* context
+ *   The tree building state.
+ *
+ * @return int
+ *   Returns 1 on success; otherwise, 0.
+ */
+static int _decoder_tree_array_start(void *context) {
+  return _decoder_tree_container(context, JSON_array);
+}
+
+/**
+ * Handles the end of an object by recording its last member and number of members.
+ *
+ * Large objects decoded into a document arena get the index of their keys
+ * right away, since nothing would free an index built later on.
+ *
+ * @param void* context
+ *   The tree building state.
+ *
+ * @return int
+ *   Returns 1 on success; otherwise, 0.
+ */
+static int _decoder_tree_object_end(void *context) {
+  struct json_decoder_tree *tree = (struct json_decoder_tree *)context;
+  struct json_decoder *decoder = tree->decoder;
+  // The decoder already popped the frame of the object.
+  struct json_decoder_frame *frame = &decoder->frames[decoder->depth];
+  frame->container->scalar.children.tail = frame->tail;
+  _json_children_set_count(frame->container, frame->count);
+  if (decoder->arena == NULL || frame->count < JSON_INDEX_MIN_MEMBERS) {
+    return 1;
   }
-  // Create the array instance.
-  struct json *json_array = json_create(JSON_array, head);
-  if (json_array == NULL) {
-    free(head);
-    return NULL;
+  struct json_index *index = (struct json_index *)_arena_alloc(decoder->arena, _json_index_size(frame->count));
+  if (index == NULL) {
+    return 0;
   }
-  // JSON array decoding completed.
-  return json_array;
+  _json_index_fill(index, frame->count, (struct json *)frame->container->value);
+  _json_children_set_extension(frame->container, index);
+  return 1;
 }
 
 /**
- * {@inheritdoc}
+ * Handles the end of an array by recording its last element and number of elements.
+ *
+ * Long arrays decoded into a document arena get the vector of their elements
+ * right away, since nothing would free a vector built later on.
+ *
+ * @param void* context
+ *   The tree building state.
+ *
+ * @return int
+ *   Returns 1 on success; otherwise, 0.
  */
-struct json *_decode_json_object(struct StringTokenizer *tokenizer) {
-  // Get the current token in the tokenizer.
-  char token = st_current_token(tokenizer);
-  // Check the start of the object.
-  if (token != '{') {
-    // Not an object.
-    return NULL;
+static int _decoder_tree_array_end(void *context) {
+  struct json_decoder_tree *tree = (struct json_decoder_tree *)context;
+  struct json_decoder *decoder = tree->decoder;
+  // The decoder already popped the frame of the array.
+  struct json_decoder_frame *frame = &decoder->frames[decoder->depth];
+  frame->container->scalar.children.tail = frame->tail;
+  _json_children_set_count(frame->container, frame->count);
+  if (decoder->arena == NULL || frame->count < JSON_VECTOR_MIN_ELEMENTS) {
+    return 1;
   }
-  // Loop through the comma separated array elements.
-  struct json *head = NULL, *current = NULL, *prev = NULL;
-  do {
-    // Move to the next valid token.
-    st_next_token(tokenizer);
-    token = st_current_token(tokenizer);
-    // Extract the object key.
-    char *key = st_sub_string(tokenizer, '\"', '\"');
-    if (key == NULL) {
-      return NULL;
+  struct json_vector *vector = (struct json_vector *)_arena_alloc(decoder->arena, _json_vector_size(frame->count));
+  if (vector == NULL) {
+    return 0;
+  }
+  _json_vector_fill(vector, frame->count, (struct json *)frame->container->value);
+  _json_children_set_extension(frame->container, vector);
+  return 1;
+}
+
+/**
+ * Handles an object key by appending a new key node to the innermost object.
+ *
+ * In zero-copy mode the key is a view into the input; otherwise it is copied.
+ *
+ * @param void* context
+ *   The tree building state.
+ * @param const char* key
+ *   The key characters.
+ * @param size_t length
+ *   The number of key characters.
+ *
+ * @return int
+ *   Returns 1 on success; otherwise, 0.
+ */
+static int _decoder_tree_key(void *context, const char *key, size_t length) {
+  struct json_decoder_tree *tree = (struct json_decoder_tree *)context;
+  struct json_decoder *decoder = tree->decoder;
+  struct json_decoder_frame *frame = &decoder->frames[decoder->depth - 1];
+  // Create the key node.
+  struct json *current = _decoder_create(decoder, JSON_object, NULL);
+  if (current == NULL) {
+    return 0;
+  }
+  const int strict = (decoder->flags & JSON_DECODE_STRICT) != 0;
+  current->key_length = length;
+  if ((decoder->flags & JSON_DECODE_ZERO_COPY) != 0 && memchr(key, '\\', length) == NULL) {
+    // Reference the key characters in the input.
+    if (strict && _json_unescape_string(NULL, key, length, 1, &current->key_length) == 0) {
+      _decoder_destroy(decoder, current);
+      return 0;
     }
-    // Check for the colon (:) character.
-    st_next_token(tokenizer);
-    token = st_current_token(tokenizer);
-    if (token != ':') {
-      free(key);
-      return NULL;
+    current->key = (char *)key;
+    current->flags |= JSON_FLAG_KEY_VIEW;
+  } else {
+    // Copy the key characters, resolving their escape sequences.
+    current->key = _decoder_alloc_string(decoder, current, length, JSON_FLAG_KEY_POOLED);
+    if (current->key == NULL) {
+      _decoder_destroy(decoder, current);
+      return 0;
     }
-    // Get the next valid token.
-    st_next_token(tokenizer);
-    token = st_current_token(tokenizer);
-    // Decodes the object value.
-    struct json *value = _decode_json(tokenizer);
-    if (value == NULL) {
-      free(key);
-      return NULL;
+    if (_json_unescape_string(current->key, key, length, strict, &current->key_length) == 0) {
+      current->key[0] = '\0';
+      _decoder_destroy(decoder, current);
+      return 0;
     }
-    // Create the object instance.
-    current = json_create(JSON_object, value);
-    if (current == NULL) {
-      free(key);
-      free(value);
-      return NULL;
+    current->key[current->key_length] = '\0';
+  }
+  // Updates the position of the current key in the linked list.
+  if (frame->tail == NULL) {
+    frame->container->value = current;
+  } else {
+    frame->tail->next = current;
+    current->prev = frame->tail;
+  }
+  frame->tail = current;
+  frame->count++;
+  return 1;
+}
+
+/**
+ * Handles a string value.
+ *
+ * @param void* context
+ *   The tree building state.
+ * @param const char* value
+ *   The string characters.
+ * @param size_t length
+ *   The number of string characters.
+ *
+ * @return int
+ *   Returns 1 on success; otherwise, 0.
+ */
+static int _decoder_tree_string(void *context, const char *value, size_t length) {
+  struct json_decoder_tree *tree = (struct json_decoder_tree *)context;
+  struct json_decoder *decoder = tree->decoder;
+  const int strict = (decoder->flags & JSON_DECODE_STRICT) != 0;
+  // Reference the string characters in the input.
+  if ((decoder->flags & JSON_DECODE_ZERO_COPY) != 0) {
+    size_t validated = 0;
+    if (strict && _json_unescape_string(NULL, value, length, 1, &validated) == 0) {
+      return 0;
+    }
+    struct json *view = _decoder_create_view(decoder, value, length);
+    if (view == NULL) {
+      return 0;
+    }
+    _decoder_tree_attach(tree, view, decoder->depth);
+    return 1;
+  }
+  // Init the JSON object instance.
+  struct json *json_object = _decoder_create(decoder, JSON_string, NULL);
+  if (json_object == NULL) {
+    return 0;
+  }
+  _decoder_tree_attach(tree, json_object, decoder->depth);
+  // Short strings are stored inline.
+  char *copy = json_object->scalar.string;
+  if (length >= JSON_INLINE_STRING_SIZE) {
+    copy = _decoder_alloc_string(decoder, json_object, length, JSON_FLAG_VALUE_POOLED);
+    if (copy == NULL) {
+      return 0;
+    }
+  }
+  // Copy the string characters, validating them and resolving their escape sequences in one pass.
+  if (_json_unescape_string(copy, value, length, strict, &length) == 0) {
+    if (copy != json_object->scalar.string && decoder->arena == NULL) {
+      _json_free_string(json_object, copy, JSON_FLAG_VALUE_POOLED);
     }
-    // Set the object value and the key.
-    current->key = key;
-    current->value = value;
-    // Get the next valid token.
-    st_next_token(tokenizer);
-    token = st_current_token(tokenizer);
-    // Updates the position of the current element in the linked list.
-    if (head == NULL) {
-      head = current;
-      prev = current;
-    } else {
-      prev->next = current;
-      current->prev = prev;
-      prev = current;
-    }
-  } while (token == ',');
-  // Check the JSON object closing token.
-  if (token != '}') {
-    json_destroy(head);
+    return 0;
+  }
+  copy[length] = '\0';
+  json_object->value = copy;
+  return 1;
+}
+
+/**
+ * Handles a number value.
+ *
+ * @param void* context
+ *   The tree building state.
+ * @param double value
+ *   The number value.
+ *
+ * @return int
+ *   Returns 1 on success; otherwise, 0.
+ */
+static int _decoder_tree_number(void *context, double value) {
+  struct json *json_object = _decoder_tree_scalar(context, JSON_number);
+  if (json_object == NULL) {
+    return 0;
+  }
+  json_object->scalar.number = value;
+  return 1;
+}
+
+/**
+ * Handles an integer value.
+ *
+ * @param void* context
+ *   The tree building state.
+ * @param int64_t value
+ *   The integer value.
+ *
+ * @return int
+ *   Returns 1 on success; otherwise, 0.
+ */
+static int _decoder_tree_integer(void *context, int64_t value) {
+  struct json *json_object = _decoder_tree_scalar(context, JSON_number);
+  if (json_object == NULL) {
+    return 0;
+  }
+  json_object->flags |= JSON_FLAG_INTEGER;
+  json_object->scalar.integer.number = (double)value;
+  json_object->scalar.integer.value = value;
+  return 1;
+}
+
+/**
+ * Handles an integer value above INT64_MAX.
+ *
+ * @param void* context
+ *   The tree building state.
+ * @param uint64_t value
+ *   The integer value.
+ *
+ * @return int
+ *   Returns 1 on success; otherwise, 0.
+ */
+static int _decoder_tree_unsigned(void *context, uint64_t value) {
+  struct json *json_object = _decoder_tree_scalar(context, JSON_number);
+  if (json_object == NULL) {
+    return 0;
+  }
+  json_object->flags |= JSON_FLAG_INTEGER | JSON_FLAG_UNSIGNED;
+  json_object->scalar.integer.number = (double)value;
+  json_object->scalar.integer.value = (int64_t)value;
+  return 1;
+}
+
+/**
+ * Handles a boolean value.
+ *
+ * @param void* context
+ *   The tree building state.
+ * @param int value
+ *   The boolean value.
+ *
+ * @return int
+ *   Returns 1 on success; otherwise, 0.
+ */
+static int _decoder_tree_boolean(void *context, int value) {
+  struct json *json_object = _decoder_tree_scalar(context, JSON_boolean);
+  if (json_object == NULL) {
+    return 0;
+  }
+  json_object->scalar.boolean = value;
+  return 1;
+}
+
+/**
+ * Handles a null value.
+ *
+ * @param void* context
+ *   The tree building state.
+ *
+ * @return int
+ *   Returns 1 on success; otherwise, 0.
+ */
+static int _decoder_tree_null(void *context) {
+  return _decoder_tree_scalar(context, JSON_null) != NULL;
+}
+
+/**
+ * The callbacks building a JSON object from the decoder events.
+ */
+static const struct json_sax_handler _decoder_tree_handler = {
+  _decoder_tree_object_start,
+  _decoder_tree_object_end,
+  _decoder_tree_array_start,
+  _decoder_tree_array_end,
+  _decoder_tree_key,
+  _decoder_tree_string,
+  _decoder_tree_number,
+  _decoder_tree_boolean,
+  _decoder_tree_null,
+  _decoder_tree_integer,
+  _decoder_tree_unsigned
+};
+
+/**
+ * {@inheritdoc}
+ */
+void _decoder_build_tree(struct json_decoder *decoder, struct json_decoder_tree *tree) {
+  tree->decoder = decoder;
+  tree->root = NULL;
+  decoder->handler = &_decoder_tree_handler;
+  decoder->context = tree;
+  decoder->handler_validates = 1;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void _decoder_destroy_tree(struct json_decoder_tree *tree) {
+  _decoder_destroy(tree->decoder, tree->root);
+  tree->root = NULL;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct json *_decode_json(struct json_decoder *decoder) {
+  struct json_decoder_tree tree;
+  _decoder_build_tree(decoder, &tree);
+  // Discard the partially decoded JSON object on errors.
+  if (_decoder_parse(decoder) == 0) {
+    _decoder_destroy(decoder, tree.root);
     return NULL;
   }
-  // JSON object decoding completed.
-  return head;
+  // JSON decoding completed.
+  return tree.root;
 }
@@ -1,84 +1,356 @@
 #ifndef JSON_DECODER_H
 #define JSON_DECODER_H
 
-#include <strutils.h>
+#include <stddef.h>
+#include "arena.h"
+#include "structural.h"
 #include "../include/json.h"
 
 /**
- * Decodes the given a JSON encoded string and converts it into a JSON object.
+ * The token expected by the decoder next.
+ */
+enum json_decoder_state {
+  JSON_DECODER_VALUE,
+  JSON_DECODER_FIRST_VALUE,
+  JSON_DECODER_KEY,
+  JSON_DECODER_FIRST_KEY,
+  JSON_DECODER_COLON,
+  JSON_DECODER_NEXT,
+  JSON_DECODER_DONE
+};
+
+/**
+ * The data struct definition for an open container on the decoder stack.
+ */
+struct json_decoder_frame {
+
+  /**
+   * Whether the container is an object (1) or an array (0).
+   *
+   * @var int is_object.
+   */
+  int is_object;
+
+  /**
+   * The JSON object or array being decoded, when decoding into a tree.
+   *
+   * @var struct json* container.
+   */
+  struct json *container;
+
+  /**
+   * The latest key node (objects) or element (arrays) of the container.
+   *
+   * @var struct json* tail.
+   */
+  struct json *tail;
+
+  /**
+   * The number of members or elements of the container, when decoding into a tree.
+   *
+   * @var size_t count.
+   */
+  size_t count;
+};
+
+/**
+ * The data struct definition for the JSON decoder state.
+ */
+struct json_decoder {
+
+  /**
+   * The JSON encoded string being decoded.
+   *
+   * @var const char* input.
+   */
+  const char *input;
+
+  /**
+   * The number of characters in the input.
+   *
+   * @var size_t length.
+   */
+  size_t length;
+
+  /**
+   * The position of the current token in the input.
+   *
+   * @var size_t position.
+   */
+  size_t position;
+
+  /**
+   * The arena that owns the decoded nodes and values.
+   *
+   * When NULL, every node and value is allocated on the heap.
+   *
+   * @var struct json_arena* arena.
+   */
+  struct json_arena *arena;
+
+  /**
+   * The allocator of the temporary buffers: the one of the arena, if any.
+   *
+   * @var const struct json_allocator* allocator.
+   */
+  const struct json_allocator *allocator;
+
+  /**
+   * The maximum nesting depth of arrays and objects.
+   *
+   * @var size_t max_depth.
+   */
+  size_t max_depth;
+
+  /**
+   * The JSON_DECODE_* flags.
+   *
+   * @var int flags.
+   */
+  int flags;
+
+  /**
+   * The callbacks the decoded values are reported to.
+   *
+   * @var const struct json_sax_handler* handler.
+   */
+  const struct json_sax_handler *handler;
+
+  /**
+   * The context passed to the handler callbacks.
+   *
+   * @var void* context.
+   */
+  void *context;
+
+  /**
+   * The token expected next.
+   *
+   * @var enum json_decoder_state state.
+   */
+  enum json_decoder_state state;
+
+  /**
+   * Whether the input may continue in a later buffer.
+   *
+   * Tokens cut off by the end of the input are then left for the next buffer
+   * instead of being rejected.
+   *
+   * @var int partial.
+   */
+  int partial;
+
+  /**
+   * The number of characters of the current string token, after its opening
+   * double quote, already scanned without finding its end.
+   *
+   * A string cut off by the end of a partial input is scanned again from its
+   * start in the next input, so the search resumes from there instead.
+   *
+   * @var size_t scanned.
+   */
+  size_t scanned;
+
+  /**
+   * Whether the handler validates the strings it is reported itself.
+   *
+   * Otherwise strict decoding validates every string before reporting it.
+   *
+   * @var int handler_validates.
+   */
+  int handler_validates;
+
+  /**
+   * The stack of open containers.
+   *
+   * Nesting is tracked on this heap allocated stack instead of the C stack.
+   *
+   * @var struct json_decoder_frame* frames.
+   */
+  struct json_decoder_frame *frames;
+
+  /**
+   * The number of open containers.
+   *
+   * @var size_t depth.
+   */
+  size_t depth;
+
+  /**
+   * The number of frames the stack can hold before growing.
+   *
+   * @var size_t capacity.
+   */
+  size_t capacity;
+
+  /**
+   * The structural index of the input, built before decoding large inputs.
+   *
+   * When available, moving to the next token is a lookup in the index instead
+   * of a character by character scan. The input is indexed window by window as
+   * the decoder moves forward, so the index never runs far past the end of the
+   * decoded value.
+   *
+   * @var struct json_structural_index index.
+   */
+  struct json_structural_index index;
+
+  /**
+   * The input position the structural index offsets are relative to.
+   *
+   * @var size_t index_base.
+   */
+  size_t index_base;
+
+  /**
+   * The position in the current structural index window of the current token.
+   *
+   * @var size_t index_cursor.
+   */
+  size_t index_cursor;
+};
+
+/**
+ * The data struct definition for the state of the tree building handler.
+ */
+struct json_decoder_tree {
+
+  /**
+   * The decoder instance, which also holds the open containers.
+   *
+   * @var struct json_decoder* decoder.
+   */
+  struct json_decoder *decoder;
+
+  /**
+   * The decoded root.
+   *
+   * @var struct json* root.
+   */
+  struct json *root;
+};
+
+/**
+ * Initializes a decoder over the given JSON encoded string.
  *
- * @param struct StringTokenizer* tokenizer
- *   The string tokenizer instance.
+ * The decoder is positioned on the first non-whitespace character.
  *
- * @return struct json*
- *   Returns the decoded JSON object instance; otherwise, NULL.
+ * @param struct json_decoder* decoder
+ *   The decoder instance.
+ * @param const char* input
+ *   The JSON encoded string being decoded.
+ * @param size_t length
+ *   The number of characters in the input.
+ * @param struct json_arena* arena
+ *   The arena that owns the decoded values, or NULL to use the heap.
  */
-struct json* _decode_json(struct StringTokenizer* tokenizer);
+void _decoder_init(struct json_decoder *decoder, const char *input, size_t length, struct json_arena *arena);
 
 /**
- * Decodes a JSON string value.
+ * Returns the current token of the decoder.
  *
- * @param struct StringTokenizer* tokenizer
- *   The string tokenizer instance.
+ * @param struct json_decoder* decoder
+ *   The decoder instance.
  *
- * @return struct json*
- *   Returns the decoded JSON object instance; otherwise, NULL.
+ * @return char
+ *   The current token, or '\0' once the input is exhausted.
  */
-struct json* _decode_json_string(struct StringTokenizer* tokenizer);
+char _decoder_current_token(struct json_decoder *decoder);
 
 /**
- * Decodes a JSON number value.
+ * Moves the decoder to the next non-whitespace token.
  *
- * @param struct StringTokenizer* tokenizer
- *   The string tokenizer instance.
+ * @param struct json_decoder* decoder
+ *   The decoder instance.
+ */
+void _decoder_next_token(struct json_decoder *decoder);
+
+/**
+ * Moves the decoder to a new input buffer, keeping its parsing state.
  *
- * @return struct json*
- *   Returns the decoded JSON object instance; otherwise, NULL.
+ * @param struct json_decoder* decoder
+ *   The decoder instance.
+ * @param const char* input
+ *   The JSON encoded buffer continuing the previous input.
+ * @param size_t length
+ *   The number of characters in the input.
  */
-struct json* _decode_json_number(struct StringTokenizer* tokenizer);
+void _decoder_set_input(struct json_decoder *decoder, const char *input, size_t length);
 
 /**
- * Decodes a JSON boolean value.
+ * Moves the decoder past a complete root value, ready for the next one.
  *
- * @param struct StringTokenizer* tokenizer
- *   The string tokenizer instance.
+ * @param struct json_decoder* decoder
+ *   The decoder instance.
+ */
+void _decoder_skip_value(struct json_decoder *decoder);
+
+/**
+ * Consumes tokens until the root value is complete.
  *
- * @return struct json*
- *   Returns the decoded JSON object instance; otherwise, NULL.
+ * @param struct json_decoder* decoder
+ *   The decoder instance.
+ *
+ * @return int
+ *   Returns 1 when the root value is complete, -1 when the decoder is partial
+ *   and waits for more input (it is then left on the start of the cut off
+ *   token); otherwise, 0.
+ */
+int _decoder_run(struct json_decoder *decoder);
+
+/**
+ * Releases the decoder stack and structural index.
+ *
+ * @param struct json_decoder* decoder
+ *   The decoder instance.
  */
-struct json* _decode_json_boolean(struct StringTokenizer* tokenizer);
+void _decoder_release(struct json_decoder *decoder);
 
 /**
- * Decodes a JSON null value.
+ * Parses the JSON value at the current token and reports it to the handler.
  *
- * @param struct StringTokenizer* tokenizer
- *   The string tokenizer instance.
+ * Arrays and objects are parsed iteratively, so the nesting depth is only
+ * bounded by the decoder max_depth and not by the C stack. On success the
+ * decoder is left on the last character of the parsed value; on errors it is
+ * left on the offending token.
  *
- * @return struct json*
- *   Returns the decoded JSON object instance; otherwise, NULL.
+ * @param struct json_decoder* decoder
+ *   The decoder instance.
+ *
+ * @return int
+ *   Returns 1 when the whole value was parsed; otherwise, 0.
  */
-struct json* _decode_json_null(struct StringTokenizer* tokenizer);
+int _decoder_parse(struct json_decoder *decoder);
 
 /**
- * Decodes a JSON array value.
+ * Decodes the given a JSON encoded string and converts it into a JSON object.
  *
- * @param struct StringTokenizer* tokenizer
- *   The string tokenizer instance.
+ * The JSON object is built by a handler receiving the _decoder_parse() events.
+ *
+ * @param struct json_decoder* decoder
+ *   The decoder instance.
  *
  * @return struct json*
  *   Returns the decoded JSON object instance; otherwise, NULL.
  */
-struct json* _decode_json_array(struct StringTokenizer* tokenizer);
+struct json* _decode_json(struct json_decoder* decoder);
 
 /**
- * Decodes a JSON object value.
+ * Makes the decoder build a JSON object from the values it parses.
  *
- * @param struct StringTokenizer* tokenizer
- *   The string tokenizer instance.
+ * @param struct json_decoder* decoder
+ *   The decoder instance.
+ * @param struct json_decoder_tree* tree
+ *   Receives the tree building state; tree->root holds the decoded root.
+ */
+void _decoder_build_tree(struct json_decoder *decoder, struct json_decoder_tree *tree);
+
+/**
+ * Destroys the partially decoded root of a tree building state.
  *
- * @return struct json*
- *   Returns the decoded JSON object instance; otherwise, NULL.
+ * @param struct json_decoder_tree* tree
+ *   The tree building state.
  */
-struct json* _decode_json_object(struct StringTokenizer* tokenizer);
+void _decoder_destroy_tree(struct json_decoder_tree *tree);
 
 #endif
@@ -0,0 +1,130 @@
+#include <stdlib.h>
+#include <string.h>
+#include "allocator.h"
+#include "decoder.h"
+#include "document.h"
+
+/**
+ * {@inheritdoc}
+ */
+struct json_document *json_document_create() {
+  return json_document_create_with_allocator(NULL);
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct json_document *json_document_create_with_allocator(const struct json_allocator *allocator) {
+  if (allocator != NULL && (allocator->alloc == NULL || allocator->realloc == NULL || allocator->free == NULL)) {
+    return NULL;
+  }
+  struct json_document *document = (struct json_document *)_json_alloc(allocator, sizeof(struct json_document));
+  if (document == NULL) {
+    return NULL;
+  }
+  // Keep a copy of the allocator, which the arena refers to.
+  if (allocator != NULL) {
+    document->allocator = *allocator;
+  }
+  _arena_init(&document->arena, allocator != NULL ? &document->allocator : NULL);
+  document->root = NULL;
+  document->options.max_depth = 0;
+  document->options.flags = 0;
+  document->mappings = NULL;
+  return document;
+}
+
+/**
+ * Releases the files mapped into memory by a document.
+ *
+ * @param struct json_document* document
+ *   The document instance.
+ */
+static void _document_unmap_files(struct json_document *document) {
+  struct json_mapping *mapping = document->mappings;
+  while (mapping != NULL) {
+    struct json_mapping *next = mapping->next;
+    _json_unmap_file(mapping);
+    mapping = next;
+  }
+  document->mappings = NULL;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct json *json_decode_into(struct json_document *document, const char *json_string) {
+  if (document == NULL || json_string == NULL) {
+    return NULL;
+  }
+  return _json_document_decode(document, json_string, strlen(json_string));
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct json *_json_document_decode(struct json_document *document, const char *buffer, size_t length) {
+  // Init the decoder over the document arena.
+  struct json_decoder decoder;
+  _decoder_init(&decoder, buffer, length, &document->arena);
+  if (document->options.max_depth > 0) {
+    decoder.max_depth = document->options.max_depth;
+  }
+  decoder.flags = document->options.flags;
+  // Try to decode the JSON buffer.
+  document->root = _decode_json(&decoder);
+  // Return the decoded JSON object.
+  return document->root;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct json *json_document_root(struct json_document *document) {
+  if (document == NULL) {
+    return NULL;
+  }
+  return document->root;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void json_document_set_options(struct json_document *document, const struct json_decode_options *options) {
+  if (document == NULL) {
+    return;
+  }
+  document->options.max_depth = options != NULL ? options->max_depth : 0;
+  document->options.flags = options != NULL ? options->flags : 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void json_document_reset(struct json_document *document) {
+  if (document == NULL) {
+    return;
+  }
+  _document_unmap_files(document);
+  _arena_reset(&document->arena);
+  document->root = NULL;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void json_document_free(struct json_document *document) {
+  if (document == NULL) {
+    return;
+  }
+  _document_unmap_files(document);
+  _arena_release(&document->arena);
+  // Copy the allocator out of the document before releasing it.
+  struct json_allocator allocator;
+  const struct json_allocator *owner = NULL;
+  if (document->arena.allocator != NULL) {
+    allocator = document->allocator;
+    owner = &allocator;
+  }
+  _json_free(owner, document);
+}
@@ -0,0 +1,67 @@
+#ifndef JSON_DOCUMENT_INTERNAL_H
+#define JSON_DOCUMENT_INTERNAL_H
+
+#include "arena.h"
+#include "mapping.h"
+#include "../include/json.h"
+
+/**
+ * The data struct definition for a JSON document.
+ *
+ * A document owns an arena from which every node, key and value decoded into
+ * it is carved, so the whole tree is released at once.
+ */
+struct json_document {
+
+  /**
+   * The arena that owns the document nodes and values.
+   *
+   * @var struct json_arena arena.
+   */
+  struct json_arena arena;
+
+  /**
+   * The root of the latest JSON object decoded into the document.
+   *
+   * @var struct json* root.
+   */
+  struct json *root;
+
+  /**
+   * The options used to decode into the document.
+   *
+   * @var struct json_decode_options options.
+   */
+  struct json_decode_options options;
+
+  /**
+   * The files mapped into memory by the document, released with the arena.
+   *
+   * @var struct json_mapping* mappings.
+   */
+  struct json_mapping *mappings;
+
+  /**
+   * The allocator given on creation, if any, which the arena refers to.
+   *
+   * @var struct json_allocator allocator.
+   */
+  struct json_allocator allocator;
+};
+
+/**
+ * Decodes the given buffer into the document with the document options.
+ *
+ * @param struct json_document* document
+ *   The document that owns the decoded JSON object.
+ * @param const char* buffer
+ *   The json buffer being decoded.
+ * @param size_t length
+ *   The number of characters in the buffer.
+ *
+ * @return struct json*
+ *   The pointer to the decoded JSON object, otherwise NULL.
+ */
+struct json *_json_document_decode(struct json_document *document, const char *buffer, size_t length);
+
+#endif /* JSON_DOCUMENT_INTERNAL_H */
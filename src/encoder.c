@@ -1,37 +1,42 @@
+#include <stdlib.h>
 #include <string.h>
+#include "allocator.h"
 #include "encoder.h"
+#include "escape.h"
+#include "node.h"
+#include "number.h"
 
 /**
  * {@inheritdoc}
  */
-int _encode_json(struct json *json_object, struct StringTokenizer *tokenizer) {
-  if (json_object == NULL || tokenizer == NULL) {
+int _encode_json(struct json *json_object, struct json_writer *writer) {
+  if (json_object == NULL || writer == NULL) {
     return 0;
   }
   // Encodes the object based on the different types of JSON values.
   // Check for object token.
   if (json_object->type == JSON_object) {
-    return _encode_json_object(json_object, tokenizer);
+    return _encode_json_object(json_object, writer);
   }
   // Check for array token.
   if (json_object->type == JSON_array) {
-    return _encode_json_array(json_object, tokenizer);
+    return _encode_json_array(json_object, writer);
   }
   // Check for string double-quote token.
   if (json_object->type == JSON_string) {
-    return _encode_json_string(json_object, tokenizer);
+    return _encode_json_string(json_object, writer);
   }
   // Check for number token.
   if (json_object->type == JSON_number) {
-    return _encode_json_number(json_object, tokenizer);
+    return _encode_json_number(json_object, writer);
   }
   // Check for boolean tokens(true or false).
   if (json_object->type == JSON_boolean) {
-    return _encode_json_boolean(json_object, tokenizer);
+    return _encode_json_boolean(json_object, writer);
   }
   // Check for null token.
   if (json_object->type == JSON_null) {
-    return _encode_json_null(json_object, tokenizer);
+    return _encode_json_null(json_object, writer);
   }
   // Invalid JSON token.
   return 0;
@@ -40,13 +45,214 @@ int _encode_json(struct json *json_object, struct StringTokenizer *tokenizer) {
 /**
  * {@inheritdoc}
  */
-int _encode_json_string(struct json *json_object, struct StringTokenizer *tokenizer) {
+int _encode_json_with_options(struct json *json_object, struct json_writer *writer, const struct json_encode_options *options, size_t depth) {
+  if (json_object == NULL || writer == NULL) {
+    return 0;
+  }
+  // Without indentation or sorting, the output is the plain encoding.
+  if (options == NULL || (options->indent == 0 && (options->flags & JSON_ENCODE_SORT_KEYS) == 0)) {
+    return _encode_json(json_object, writer);
+  }
+  // Only containers are laid out differently.
+  if (json_object->type == JSON_object) {
+    return _encode_json_object_with_options(json_object, writer, options, depth);
+  }
+  if (json_object->type == JSON_array) {
+    return _encode_json_array_with_options(json_object, writer, options, depth);
+  }
+  return _encode_json(json_object, writer);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int _encode_json_key(struct json *member, struct json_writer *writer) {
+  return _json_escape_string(writer, member->key, member->key_length);
+}
+
+/**
+ * Starts a new line indented for the given nesting depth.
+ *
+ * @param struct json_writer* writer
+ *   The writer receiving the encoded characters.
+ * @param size_t indent
+ *   The number of spaces each nesting level is indented by.
+ * @param size_t depth
+ *   The nesting depth of the line.
+ *
+ * @return int
+ *   Returns 1 when the line was started; otherwise, 0.
+ */
+static int _encode_newline(struct json_writer *writer, size_t indent, size_t depth) {
+  static const char spaces[] = "                                                                ";
+  if (_writer_put(writer, '\n') == 0) {
+    return 0;
+  }
+  // Write the indentation in runs of spaces.
+  size_t remaining = indent * depth;
+  while (remaining > 0) {
+    const size_t length = remaining < sizeof(spaces) - 1 ? remaining : sizeof(spaces) - 1;
+    if (_writer_write(writer, spaces, length) == 0) {
+      return 0;
+    }
+    remaining -= length;
+  }
+  return 1;
+}
+
+/**
+ * Compares two object members by key, byte by byte.
+ *
+ * @param const void* a
+ *   The pointer to the first member pointer.
+ * @param const void* b
+ *   The pointer to the second member pointer.
+ *
+ * @return int
+ *   A negative value, zero or a positive value when the first key sorts
+ *   before, equal to or after the second key.
+ */
+static int _encode_compare_members(const void *a, const void *b) {
+  const struct json *first = *(struct json *const *)a;
+  const struct json *second = *(struct json *const *)b;
+  const size_t length = first->key_length < second->key_length ? first->key_length : second->key_length;
+  const int order = memcmp(first->key, second->key, length);
+  if (order != 0) {
+    return order;
+  }
+  return (first->key_length > second->key_length) - (first->key_length < second->key_length);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int _encode_json_object_with_options(struct json *json_object, struct json_writer *writer, const struct json_encode_options *options, size_t depth) {
+  if (json_object->type != JSON_object) {
+    return 0;
+  }
+  // Find the first member, as the plain encoding does.
+  struct json *first = json_object;
+  if (first->key == NULL && first->value != NULL) {
+    first = first->value;
+  }
+  // Count the members holding both a key and a value.
+  size_t count = 0;
+  for (struct json *current = first; current != NULL; current = current->next) {
+    if (current->key != NULL && current->value != NULL) {
+      count++;
+    }
+  }
+  if (count == 0) {
+    return _writer_write(writer, "{}", 2);
+  }
+  // Collect the members in key order, when sorting.
+  struct json **members = NULL;
+  if ((options->flags & JSON_ENCODE_SORT_KEYS) != 0) {
+    members = (struct json **)_json_alloc(writer->allocator, count * sizeof(struct json *));
+    if (members == NULL) {
+      return 0;
+    }
+    size_t index = 0;
+    for (struct json *current = first; current != NULL; current = current->next) {
+      if (current->key != NULL && current->value != NULL) {
+        members[index++] = current;
+      }
+    }
+    qsort(members, count, sizeof(struct json *), _encode_compare_members);
+  }
+  // Append the members, one per line when indenting.
+  int status = _writer_put(writer, '{');
+  struct json *current = first;
+  for (size_t index = 0; status && index < count; index++) {
+    if (members != NULL) {
+      current = members[index];
+    } else {
+      while (current->key == NULL || current->value == NULL) {
+        current = current->next;
+      }
+    }
+    if (index > 0) {
+      status = _writer_put(writer, ',');
+    }
+    if (status && options->indent > 0) {
+      status = _encode_newline(writer, options->indent, depth + 1);
+    }
+    status = status && _encode_json_key(current, writer);
+    status = status && (options->indent > 0 ? _writer_write(writer, ": ", 2) : _writer_put(writer, ':'));
+    status = status && _encode_json_with_options(current->value, writer, options, depth + 1);
+    current = current->next;
+  }
+  _json_free(writer->allocator, members);
+  // Append the end object token on its own line.
+  if (status && options->indent > 0) {
+    status = _encode_newline(writer, options->indent, depth);
+  }
+  return status && _writer_put(writer, '}');
+}
+
+/**
+ * {@inheritdoc}
+ */
+int _encode_json_array_with_options(struct json *json_object, struct json_writer *writer, const struct json_encode_options *options, size_t depth) {
+  if (json_object->type != JSON_array) {
+    return 0;
+  }
+  struct json *current = json_object->value;
+  if (current == NULL) {
+    return _writer_write(writer, "[]", 2);
+  }
+  // Arrays of scalars stay on a single line, when requested.
+  int multiline = options->indent > 0;
+  if (multiline && (options->flags & JSON_ENCODE_COMPACT_ARRAYS) != 0) {
+    multiline = 0;
+    for (struct json *element = current; element != NULL && multiline == 0; element = element->next) {
+      multiline = element->type == JSON_object || element->type == JSON_array;
+    }
+  }
+  // Append the elements, one per line when indenting.
+  if (_writer_put(writer, '[') == 0) {
+    return 0;
+  }
+  while (current != NULL) {
+    if (multiline && _encode_newline(writer, options->indent, depth + 1) == 0) {
+      return 0;
+    }
+    if (_encode_json_with_options(current, writer, options, depth + 1) == 0) {
+      return 0;
+    }
+    if (current->next != NULL) {
+      if (_writer_put(writer, ',') == 0) {
+        return 0;
+      }
+      if (options->indent > 0 && multiline == 0 && _writer_put(writer, ' ') == 0) {
+        return 0;
+      }
+    }
+    current = current->next;
+  }
+  // Append the end array token on its own line.
+  if (multiline && _encode_newline(writer, options->indent, depth) == 0) {
+    return 0;
+  }
+  return _writer_put(writer, ']');
+}
+
+/**
+ * {@inheritdoc}
+ */
+int _encode_json_string(struct json *json_object, struct json_writer *writer) {
   if (json_object->type != JSON_string) {
     return 0;
   }
-  // Append the string value.
+  // Append the escaped string view.
+  if ((_json_flags(json_object) & JSON_FLAG_VALUE_VIEW) != 0) {
+    size_t length = 0;
+    const char *characters = json_string_view(json_object, &length);
+    return _json_escape_string(writer, characters, length);
+  }
+  // Append the escaped string value.
   char *value = (char *)json_object->value;
-  if (value != NULL && st_append_quoted_string(tokenizer, value) == 0) {
+  if (value != NULL && _json_escape_string(writer, value, strlen(value)) == 0) {
     return 0;
   }
   // String encoding completed.
@@ -56,78 +262,75 @@ int _encode_json_string(struct json *json_object, struct StringTokenizer *tokeni
 /**
  * {@inheritdoc}
  */
-int _encode_json_number(struct json *json_object, struct StringTokenizer *tokenizer) {
+int _encode_json_number(struct json *json_object, struct json_writer *writer) {
   if (json_object->type != JSON_number) {
     return 0;
   }
-  // Append the double value.
-  double *value = (double *)json_object->value;
-  if (value != NULL && st_append_double(tokenizer, value) == 0) {
-    return 0;
+  // Append exact integers as such, and doubles with the fewest digits that read back the same.
+  char buffer[JSON_NUMBER_BUFFER_SIZE];
+  size_t length = 0;
+  if ((json_object->flags & JSON_FLAG_UNSIGNED) != 0) {
+    length = _json_format_uint64(json_unsigned_value(json_object), buffer);
+  } else if ((json_object->flags & JSON_FLAG_INTEGER) != 0) {
+    length = _json_format_int64(json_integer_value(json_object), buffer);
+  } else {
+    length = _json_format_double(json_number_value(json_object), buffer);
   }
   // Number encoding completed.
-  return 1;
+  return _writer_write(writer, buffer, length);
 }
 
 /**
  * {@inheritdoc}
  */
-int _encode_json_boolean(struct json *json_object, struct StringTokenizer *tokenizer) {
+int _encode_json_boolean(struct json *json_object, struct json_writer *writer) {
   if (json_object->type != JSON_boolean) {
     return 0;
   }
   // Get the bool value as int.
-  int *value = (int *)json_object->value;
-  // Append the true token.
-  if (*value == 1 && st_append_string(tokenizer, "true") == 1) {
-    return 1;
-  }
-  // Append the false token.
-  if (*value == 0 && st_append_string(tokenizer, "false") == 1) {
-    return 1;
-  }
-  // Boolean encoding completed.
-  return 1;
+  int value = json_bool_value(json_object);
+  // Append the true or false token.
+  return value ? _writer_write(writer, "true", 4) : _writer_write(writer, "false", 5);
 }
 
 /**
  * {@inheritdoc}
  */
-int _encode_json_null(struct json *json_object, struct StringTokenizer *tokenizer) {
+int _encode_json_null(struct json *json_object, struct json_writer *writer) {
   if (json_object->type != JSON_null) {
     return 0;
   }
   // Append the null token.
-  return st_append_string(tokenizer, "null");
+  return _writer_write(writer, "null", 4);
 }
 
 /**
  * {@inheritdoc}
  */
-int _encode_json_array(struct json *json_object, struct StringTokenizer *tokenizer) {
+int _encode_json_array(struct json *json_object, struct json_writer *writer) {
   if (json_object->type != JSON_array) {
     return 0;
   }
   // Append the start array token.
-  if (st_append_string(tokenizer, "[") == 0) {
+  if (_writer_put(writer, '[') == 0) {
     return 0;
   }
   // Loop through the comma separated array elements.
   struct json *current = json_object->value;
-  do {
+  while (current != NULL) {
     // Append the value.
-    if (_encode_json(current, tokenizer) == 0) {
+    if (_encode_json(current, writer) == 0) {
       return 0;
     }
     // Append comma(if there is a next sibling).
-    if (current->next != NULL && st_append_string(tokenizer, ",") == 0) {
+    if (current->next != NULL && _writer_put(writer, ',') == 0) {
       return 0;
     }
     // Move forward to the next sibling array.
     current = current->next;
-  } while (current != NULL);
+  }
   // Append the end array token.
-  if (st_append_string(tokenizer, "]") == 0) {
+  if (_writer_put(writer, ']') == 0) {
     return 0;
   }
   // JSON array encoding completed.
@@ -137,13 +340,13 @@ int _encode_json_array(struct json *json_object, struct StringTokenizer *tokeniz
 /**
  * {@inheritdoc}
  */
-int _encode_json_object(struct json *json_object, struct StringTokenizer *tokenizer) {
+int _encode_json_object(struct json *json_object, struct json_writer *writer) {
   // Ensure the input JSON object is of type JSON_object.
   if (json_object->type != JSON_object) {
     return 0;
   }
   // Append the start object token '{'.
-  if (st_append_string(tokenizer, "{") == 0) {
+  if (_writer_put(writer, '{') == 0) {
     return 0;
   }
   // Initialize the pointer to iterate through the JSON object's elements.
@@ -156,28 +359,28 @@ int _encode_json_object(struct json *json_object, struct StringTokenizer *tokeni
   do {
     // Check if both key and value are non-NULL before processing.
     if (current->key != NULL && current->value != NULL) {
-      // Append the key enclosed in quotes.
-      if (st_append_quoted_string(tokenizer, current->key) == 0) {
+      // Append the escaped key enclosed in quotes.
+      if (_encode_json_key(current, writer) == 0) {
         return 0;
       }
       // Append the colon token ':' to separate key and value.
-      if (st_append_string(tokenizer, ":") == 0) {
+      if (_writer_put(writer, ':') == 0) {
         return 0;
       }
       // Append the encoded value.
-      if (_encode_json(current->value, tokenizer) == 0) {
+      if (_encode_json(current->value, writer) == 0) {
         return 0;
       }
     }
     // Append a comma ',' if there is a next sibling element.
-    if (current->next != NULL && st_append_string(tokenizer, ",") == 0) {
+    if (current->next != NULL && _writer_put(writer, ',') == 0) {
       return 0;
     }
     // Move forward to the next sibling object.
     current = current->next;
   } while (current != NULL);
   // Append the end object token '}'.
-  if (st_append_string(tokenizer, "}") == 0) {
+  if (_writer_put(writer, '}') == 0) {
     return 0;
   }
   // JSON object encoding completed successfully.
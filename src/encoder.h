@@ -1,7 +1,7 @@
 #ifndef JSON_ENCODER_H
 #define JSON_ENCODER_H
 
-#include <strutils.h> 
+#include "writer.h"
 #include "../include/json.h"
 
 /**
@@ -9,90 +9,154 @@
  *
  * @param struct json* json_object
  *   The JSON object to decode.
- * @param struct StringTokenizer* tokenizer
- *   The string tokenizer instance.
+ * @param struct json_writer* writer
+ *   The writer receiving the encoded characters.
  *
  * @return int
  *   Returns 1 when the encoding succeeded; otherwise, 0.
  */
-int _encode_json(struct json* json_object, struct StringTokenizer* tokenizer);
+int _encode_json(struct json* json_object, struct json_writer* writer);
+
+/**
+ * Encodes the given JSON object using the given options.
+ *
+ * @param struct json* json_object
+ *   The JSON object to encode.
+ * @param struct json_writer* writer
+ *   The writer receiving the encoded characters.
+ * @param const struct json_encode_options* options
+ *   The encoding options, or NULL for the plain encoding.
+ * @param size_t depth
+ *   The nesting depth of the JSON object.
+ *
+ * @return int
+ *   Returns 1 when the encoding succeeded; otherwise, 0.
+ */
+int _encode_json_with_options(struct json* json_object, struct json_writer* writer, const struct json_encode_options* options, size_t depth);
+
+/**
+ * Encodes the escaped key of an object member, enclosed in quotes.
+ *
+ * @param struct json* member
+ *   The object member.
+ * @param struct json_writer* writer
+ *   The writer receiving the encoded characters.
+ *
+ * @return int
+ *   Returns 1 when the encoding succeeded; otherwise, 0.
+ */
+int _encode_json_key(struct json* member, struct json_writer* writer);
+
+/**
+ * Encodes a JSON object value using the given options.
+ *
+ * @param struct json* json_object
+ *   The JSON object to encode.
+ * @param struct json_writer* writer
+ *   The writer receiving the encoded characters.
+ * @param const struct json_encode_options* options
+ *   The encoding options.
+ * @param size_t depth
+ *   The nesting depth of the JSON object.
+ *
+ * @return int
+ *   Returns 1 when the encoding succeeded; otherwise, 0.
+ */
+int _encode_json_object_with_options(struct json* json_object, struct json_writer* writer, const struct json_encode_options* options, size_t depth);
+
+/**
+ * Encodes a JSON array value using the given options.
+ *
+ * @param struct json* json_object
+ *   The JSON object to encode.
+ * @param struct json_writer* writer
+ *   The writer receiving the encoded characters.
+ * @param const struct json_encode_options* options
+ *   The encoding options.
+ * @param size_t depth
+ *   The nesting depth of the JSON object.
+ *
+ * @return int
+ *   Returns 1 when the encoding succeeded; otherwise, 0.
+ */
+int _encode_json_array_with_options(struct json* json_object, struct json_writer* writer, const struct json_encode_options* options, size_t depth);
 
 /**
  * Encodes a JSON string value.
  *
  * @param struct json* json_object
  *   The JSON object to decode.
- * @param struct StringTokenizer* tokenizer
- *   The string tokenizer instance.
+ * @param struct json_writer* writer
+ *   The writer receiving the encoded characters.
  *
  * @return int
  *   Returns 1 when the encoding succeeded; otherwise, 0.
  */
-int _encode_json_string(struct json* json_object, struct StringTokenizer* tokenizer);
+int _encode_json_string(struct json* json_object, struct json_writer* writer);
 
 /**
  * Encodes a JSON number value.
  *
  * @param struct json* json_object
  *   The JSON object to decode.
- * @param struct StringTokenizer* tokenizer
- *   The string tokenizer instance.
+ * @param struct json_writer* writer
+ *   The writer receiving the encoded characters.
  *
  * @return int
  *   Returns 1 when the encoding succeeded; otherwise, 0.
  */
-int _encode_json_number(struct json* json_object, struct StringTokenizer* tokenizer);
+int _encode_json_number(struct json* json_object, struct json_writer* writer);
 
 /**
  * Encodes a JSON boolean value.
  *
  * @param struct json* json_object
  *   The JSON object to decode.
- * @param struct StringTokenizer* tokenizer
- *   The string tokenizer instance.
+ * @param struct json_writer* writer
+ *   The writer receiving the encoded characters.
  *
  * @return int
  *   Returns 1 when the encoding succeeded; otherwise, 0.
  */
-int _encode_json_boolean(struct json* json_object, struct StringTokenizer* tokenizer);
+int _encode_json_boolean(struct json* json_object, struct json_writer* writer);
 
 /**
  * Encodes a JSON null value.
  *
  * @param struct json* json_object
  *   The JSON object to decode.
- * @param struct StringTokenizer* tokenizer
- *   The string tokenizer instance.
+ * @param struct json_writer* writer
+ *   The writer receiving the encoded characters.
  *
  * @return int
  *   Returns 1 when the encoding succeeded; otherwise, 0.
  */
-int _encode_json_null(struct json* json_object, struct StringTokenizer* tokenizer);
+int _encode_json_null(struct json* json_object, struct json_writer* writer);
 
 /**
  * Encodes a JSON array value.
  *
  * @param struct json* json_object
  *   The JSON object to decode.
- * @param struct StringTokenizer* tokenizer
- *   The string tokenizer instance.
+ * @param struct json_writer* writer
+ *   The writer receiving the encoded characters.
  *
  * @return int
  *   Returns 1 when the encoding succeeded; otherwise, 0.
  */
-int _encode_json_array(struct json* json_object, struct StringTokenizer* tokenizer);
+int _encode_json_array(struct json* json_object, struct json_writer* writer);
 
 /**
  * Encodes a JSON object value.
  *
  * @param struct json* json_object
  *   The JSON object to decode.
- * @param struct StringTokenizer* tokenizer
- *   The string tokenizer instance.
+ * @param struct json_writer* writer
+ *   The writer receiving the encoded characters.
  *
  * @return int
  *   Returns 1 when the encoding succeeded; otherwise, 0.
  */
-int _encode_json_object(struct json* json_object, struct StringTokenizer* tokenizer);
+int _encode_json_object(struct json* json_object, struct json_writer* writer);
 
 #endif  /* JSON_ENCODER_H */
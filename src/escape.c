@@ -0,0 +1,577 @@
+#include <stdint.h>
+#include <string.h>
+#include "escape.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define JSON_ESCAPE_X86 1
+#endif
+
+/**
+ * The lowercase hexadecimal digits.
+ */
+static const char _json_hex_digits[] = "0123456789abcdef";
+
+/**
+ * Checks whether a character must be escaped inside a JSON string.
+ *
+ * @param unsigned char character
+ *   The character.
+ *
+ * @return int
+ *   Returns 1 for double quotes, backslashes and control characters; otherwise, 0.
+ */
+static inline int _escape_needed(unsigned char character) {
+  return character < 0x20 || character == '\"' || character == '\\';
+}
+
+/**
+ * Finds the first character that must be escaped, one character at a time.
+ *
+ * This is the portable fallback used when no SIMD kernel is supported.
+ *
+ * @param const char* characters
+ *   The characters to search.
+ * @param size_t length
+ *   The number of characters.
+ *
+ * @return size_t
+ *   The position of the first character to escape, or length when there is none.
+ */
+static size_t _escape_find_scalar(const char *characters, size_t length) {
+  for (size_t i = 0; i < length; ++i) {
+    if (_escape_needed((unsigned char)characters[i])) {
+      return i;
+    }
+  }
+  return length;
+}
+
+#ifdef JSON_ESCAPE_X86
+
+/**
+ * Finds the first character that must be escaped with SSE2 instructions, 16 bytes at a time.
+ *
+ * @param const char* characters
+ *   The characters to search.
+ * @param size_t length
+ *   The number of characters.
+ *
+ * @return size_t
+ *   The position of the first character to escape, or length when there is none.
+ */
+__attribute__((target("sse2")))
+static size_t _escape_find_sse2(const char *characters, size_t length) {
+  const __m128i quote = _mm_set1_epi8('\"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i control = _mm_set1_epi8(0x1F);
+  size_t i = 0;
+  for (; i + 16 <= length; i += 16) {
+    const __m128i chunk = _mm_loadu_si128((const __m128i *)(characters + i));
+    // Control characters are the bytes left unchanged by an unsigned max with 0x1F.
+    const __m128i matches = _mm_or_si128(
+      _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+      _mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control));
+    const unsigned mask = (unsigned)_mm_movemask_epi8(matches);
+    if (mask != 0) {
+      return i + (size_t)__builtin_ctz(mask);
+    }
+  }
+  return i + _escape_find_scalar(characters + i, length - i);
+}
+
+/**
+ * Finds the first character that must be escaped with AVX2 instructions, 32 bytes at a time.
+ *
+ * @param const char* characters
+ *   The characters to search.
+ * @param size_t length
+ *   The number of characters.
+ *
+ * @return size_t
+ *   The position of the first character to escape, or length when there is none.
+ */
+__attribute__((target("avx2")))
+static size_t _escape_find_avx2(const char *characters, size_t length) {
+  const __m256i quote = _mm256_set1_epi8('\"');
+  const __m256i backslash = _mm256_set1_epi8('\\');
+  const __m256i control = _mm256_set1_epi8(0x1F);
+  size_t i = 0;
+  for (; i + 32 <= length; i += 32) {
+    const __m256i chunk = _mm256_loadu_si256((const __m256i *)(characters + i));
+    const __m256i matches = _mm256_or_si256(
+      _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash)),
+      _mm256_cmpeq_epi8(_mm256_max_epu8(chunk, control), control));
+    const unsigned mask = (unsigned)_mm256_movemask_epi8(matches);
+    if (mask != 0) {
+      return i + (size_t)__builtin_ctz(mask);
+    }
+  }
+  return i + _escape_find_sse2(characters + i, length - i);
+}
+
+#endif /* JSON_ESCAPE_X86 */
+
+/**
+ * The kernel selected for the running CPU.
+ */
+static size_t (*_escape_finder)(const char *, size_t) = NULL;
+
+/**
+ * Selects the fastest search kernel supported by the running CPU.
+ *
+ * The selection is made once and cached for the following calls.
+ *
+ * @return size_t (*)(const char *, size_t)
+ *   The selected kernel.
+ */
+static size_t (*_escape_select_finder())(const char *, size_t) {
+  size_t (*finder)(const char *, size_t) = __atomic_load_n(&_escape_finder, __ATOMIC_RELAXED);
+  if (finder != NULL) {
+    return finder;
+  }
+  finder = _escape_find_scalar;
+#ifdef JSON_ESCAPE_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    finder = _escape_find_avx2;
+  } else if (__builtin_cpu_supports("sse2")) {
+    finder = _escape_find_sse2;
+  }
+#endif
+  __atomic_store_n(&_escape_finder, finder, __ATOMIC_RELAXED);
+  return finder;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int _json_escape_string(struct json_writer *writer, const char *characters, size_t length) {
+  size_t (*finder)(const char *, size_t) = _escape_select_finder();
+  if (_writer_put(writer, '\"') == 0) {
+    return 0;
+  }
+  size_t position = 0;
+  while (position < length) {
+    // Copy the run of characters that need no escaping as a whole.
+    const size_t run = finder(characters + position, length - position);
+    if (run > 0 && _writer_write(writer, characters + position, run) == 0) {
+      return 0;
+    }
+    position += run;
+    if (position == length) {
+      break;
+    }
+    // Escape the character that ended the run.
+    const unsigned char character = (unsigned char)characters[position++];
+    char escaped[6] = {'\\', 0, '0', '0', 0, 0};
+    size_t escaped_length = 2;
+    switch (character) {
+      case '\"':
+      case '\\':
+        escaped[1] = (char)character;
+        break;
+      case '\b':
+        escaped[1] = 'b';
+        break;
+      case '\f':
+        escaped[1] = 'f';
+        break;
+      case '\n':
+        escaped[1] = 'n';
+        break;
+      case '\r':
+        escaped[1] = 'r';
+        break;
+      case '\t':
+        escaped[1] = 't';
+        break;
+      default:
+        escaped[1] = 'u';
+        escaped[4] = _json_hex_digits[character >> 4];
+        escaped[5] = _json_hex_digits[character & 0x0F];
+        escaped_length = 6;
+        break;
+    }
+    if (_writer_write(writer, escaped, escaped_length) == 0) {
+      return 0;
+    }
+  }
+  return _writer_put(writer, '\"');
+}
+
+/**
+ * Reads the four hexadecimal digits of a \uXXXX escape sequence.
+ *
+ * @param const char* digits
+ *   The characters following "\u".
+ * @param size_t available
+ *   The number of characters available.
+ * @param uint32_t* code
+ *   Receives the code unit.
+ *
+ * @return int
+ *   Returns 1 when four hexadecimal digits were read; otherwise, 0.
+ */
+static int _unescape_hex(const char *digits, size_t available, uint32_t *code) {
+  if (available < 4) {
+    return 0;
+  }
+  uint32_t value = 0;
+  for (int i = 0; i < 4; ++i) {
+    const char digit = digits[i];
+    value <<= 4;
+    if (digit >= '0' && digit <= '9') {
+      value |= (uint32_t)(digit - '0');
+    } else if (digit >= 'a' && digit <= 'f') {
+      value |= (uint32_t)(digit - 'a' + 10);
+    } else if (digit >= 'A' && digit <= 'F') {
+      value |= (uint32_t)(digit - 'A' + 10);
+    } else {
+      return 0;
+    }
+  }
+  *code = value;
+  return 1;
+}
+
+/**
+ * Writes a code point as UTF-8.
+ *
+ * @param uint32_t code
+ *   The code point.
+ * @param char* destination
+ *   The destination, at least 4 bytes long.
+ *
+ * @return size_t
+ *   The number of bytes written.
+ */
+static size_t _unescape_utf8(uint32_t code, char *destination) {
+  if (code < 0x80) {
+    destination[0] = (char)code;
+    return 1;
+  }
+  if (code < 0x800) {
+    destination[0] = (char)(0xC0 | (code >> 6));
+    destination[1] = (char)(0x80 | (code & 0x3F));
+    return 2;
+  }
+  if (code < 0x10000) {
+    destination[0] = (char)(0xE0 | (code >> 12));
+    destination[1] = (char)(0x80 | ((code >> 6) & 0x3F));
+    destination[2] = (char)(0x80 | (code & 0x3F));
+    return 3;
+  }
+  destination[0] = (char)(0xF0 | (code >> 18));
+  destination[1] = (char)(0x80 | ((code >> 12) & 0x3F));
+  destination[2] = (char)(0x80 | ((code >> 6) & 0x3F));
+  destination[3] = (char)(0x80 | (code & 0x3F));
+  return 4;
+}
+
+/**
+ * Checks whether a character ends a clean run of string characters.
+ *
+ * @param unsigned char character
+ *   The character.
+ * @param int strict
+ *   Whether control characters and non-ASCII characters must be checked.
+ *
+ * @return int
+ *   Returns 1 for backslashes, and in strict mode for control and non-ASCII
+ *   characters; otherwise, 0.
+ */
+static inline int _unescape_needed(unsigned char character, int strict) {
+  return character == '\\' || (strict && (character < 0x20 || character >= 0x80));
+}
+
+/**
+ * Copies the clean run at the start of string characters, one character at a time.
+ *
+ * This is the portable fallback used when no SIMD kernel is supported.
+ *
+ * @param char* destination
+ *   The destination, or NULL to only measure the run.
+ * @param const char* source
+ *   The string characters.
+ * @param size_t length
+ *   The number of string characters.
+ * @param int strict
+ *   Whether control characters and non-ASCII characters end the run.
+ *
+ * @return size_t
+ *   The length of the clean run.
+ */
+static size_t _unescape_copy_scalar(char *destination, const char *source, size_t length, int strict) {
+  size_t i = 0;
+  while (i < length && !_unescape_needed((unsigned char)source[i], strict)) {
+    i++;
+  }
+  if (destination != NULL) {
+    memcpy(destination, source, i);
+  }
+  return i;
+}
+
+#ifdef JSON_ESCAPE_X86
+
+/**
+ * Copies the clean run at the start of string characters with SSE2 instructions, 16 bytes at a time.
+ *
+ * Whole blocks are stored, so up to 15 bytes past the run may be written, never past length.
+ *
+ * @param char* destination
+ *   The destination, or NULL to only measure the run.
+ * @param const char* source
+ *   The string characters.
+ * @param size_t length
+ *   The number of string characters.
+ * @param int strict
+ *   Whether control characters and non-ASCII characters end the run.
+ *
+ * @return size_t
+ *   The length of the clean run.
+ */
+__attribute__((target("sse2")))
+static size_t _unescape_copy_sse2(char *destination, const char *source, size_t length, int strict) {
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i control = _mm_set1_epi8(0x1F);
+  size_t i = 0;
+  for (; i + 16 <= length; i += 16) {
+    const __m128i chunk = _mm_loadu_si128((const __m128i *)(source + i));
+    if (destination != NULL) {
+      _mm_storeu_si128((__m128i *)(destination + i), chunk);
+    }
+    unsigned mask = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, backslash));
+    if (strict) {
+      // Non-ASCII characters have the sign bit set; control characters are left unchanged by an unsigned max with 0x1F.
+      mask |= (unsigned)_mm_movemask_epi8(chunk) | (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control));
+    }
+    if (mask != 0) {
+      return i + (size_t)__builtin_ctz(mask);
+    }
+  }
+  return i + _unescape_copy_scalar(destination != NULL ? destination + i : NULL, source + i, length - i, strict);
+}
+
+/**
+ * Copies the clean run at the start of string characters with AVX2 instructions, 32 bytes at a time.
+ *
+ * Whole blocks are stored, so up to 31 bytes past the run may be written, never past length.
+ *
+ * @param char* destination
+ *   The destination, or NULL to only measure the run.
+ * @param const char* source
+ *   The string characters.
+ * @param size_t length
+ *   The number of string characters.
+ * @param int strict
+ *   Whether control characters and non-ASCII characters end the run.
+ *
+ * @return size_t
+ *   The length of the clean run.
+ */
+__attribute__((target("avx2")))
+static size_t _unescape_copy_avx2(char *destination, const char *source, size_t length, int strict) {
+  const __m256i backslash = _mm256_set1_epi8('\\');
+  const __m256i control = _mm256_set1_epi8(0x1F);
+  size_t i = 0;
+  for (; i + 32 <= length; i += 32) {
+    const __m256i chunk = _mm256_loadu_si256((const __m256i *)(source + i));
+    if (destination != NULL) {
+      _mm256_storeu_si256((__m256i *)(destination + i), chunk);
+    }
+    unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, backslash));
+    if (strict) {
+      mask |= (unsigned)_mm256_movemask_epi8(chunk) | (unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(chunk, control), control));
+    }
+    if (mask != 0) {
+      return i + (size_t)__builtin_ctz(mask);
+    }
+  }
+  return i + _unescape_copy_sse2(destination != NULL ? destination + i : NULL, source + i, length - i, strict);
+}
+
+#endif /* JSON_ESCAPE_X86 */
+
+/**
+ * The kernel selected for the running CPU.
+ */
+static size_t (*_unescape_copier)(char *, const char *, size_t, int) = NULL;
+
+/**
+ * Selects the fastest copy kernel supported by the running CPU.
+ *
+ * The selection is made once and cached for the following calls.
+ *
+ * @return size_t (*)(char *, const char *, size_t, int)
+ *   The selected kernel.
+ */
+static size_t (*_unescape_select_copier())(char *, const char *, size_t, int) {
+  size_t (*copier)(char *, const char *, size_t, int) = __atomic_load_n(&_unescape_copier, __ATOMIC_RELAXED);
+  if (copier != NULL) {
+    return copier;
+  }
+  copier = _unescape_copy_scalar;
+#ifdef JSON_ESCAPE_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    copier = _unescape_copy_avx2;
+  } else if (__builtin_cpu_supports("sse2")) {
+    copier = _unescape_copy_sse2;
+  }
+#endif
+  __atomic_store_n(&_unescape_copier, copier, __ATOMIC_RELAXED);
+  return copier;
+}
+
+/**
+ * Measures the well-formed UTF-8 sequence at the start of the given characters.
+ *
+ * Overlong encodings, surrogates and code points above U+10FFFF are rejected.
+ *
+ * @param const char* source
+ *   The characters, starting with a non-ASCII character.
+ * @param size_t available
+ *   The number of characters available.
+ *
+ * @return size_t
+ *   The length of the sequence, or 0 when it is malformed.
+ */
+static size_t _unescape_utf8_length(const char *source, size_t available) {
+  const unsigned char *bytes = (const unsigned char *)source;
+  const unsigned char lead = bytes[0];
+  size_t length = 0;
+  unsigned char low = 0x80, high = 0xBF;
+  if (lead >= 0xC2 && lead <= 0xDF) {
+    length = 2;
+  } else if (lead >= 0xE0 && lead <= 0xEF) {
+    length = 3;
+    low = lead == 0xE0 ? 0xA0 : 0x80;
+    high = lead == 0xED ? 0x9F : 0xBF;
+  } else if (lead >= 0xF0 && lead <= 0xF4) {
+    length = 4;
+    low = lead == 0xF0 ? 0x90 : 0x80;
+    high = lead == 0xF4 ? 0x8F : 0xBF;
+  } else {
+    return 0;
+  }
+  if (available < length || bytes[1] < low || bytes[1] > high) {
+    return 0;
+  }
+  for (size_t i = 2; i < length; ++i) {
+    if (bytes[i] < 0x80 || bytes[i] > 0xBF) {
+      return 0;
+    }
+  }
+  return length;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int _json_unescape_string(char *destination, const char *source, size_t length, int strict, size_t *written_length) {
+  size_t (*copier)(char *, const char *, size_t, int) = _unescape_select_copier();
+  char code_units[4];
+  size_t read = 0;
+  size_t written = 0;
+  while (read < length) {
+    // Copy the clean run up to the next character that needs attention as a whole.
+    const size_t run = copier(destination != NULL ? destination + written : NULL, source + read, length - read, strict);
+    read += run;
+    written += run;
+    if (read == length) {
+      break;
+    }
+    const unsigned char character = (unsigned char)source[read];
+    size_t consumed = 1;
+    const char *output = source + read;
+    size_t output_length = 1;
+    if (character >= 0x80) {
+      // Validate the UTF-8 sequence and copy it as is.
+      consumed = _unescape_utf8_length(source + read, length - read);
+      if (consumed == 0) {
+        return 0;
+      }
+      output_length = consumed;
+    } else if (character != '\\') {
+      // Control characters must be escaped.
+      return 0;
+    } else if (read + 1 == length) {
+      // A lone trailing backslash.
+      if (strict) {
+        return 0;
+      }
+    } else {
+      // Resolve the escape sequence.
+      const char escape = source[read + 1];
+      uint32_t code = 0;
+      consumed = 2;
+      output = code_units;
+      output_length = 1;
+      switch (escape) {
+        case '\"':
+        case '\\':
+        case '/':
+          code_units[0] = escape;
+          break;
+        case 'b':
+          code_units[0] = '\b';
+          break;
+        case 'f':
+          code_units[0] = '\f';
+          break;
+        case 'n':
+          code_units[0] = '\n';
+          break;
+        case 'r':
+          code_units[0] = '\r';
+          break;
+        case 't':
+          code_units[0] = '\t';
+          break;
+        case 'u':
+          if (_unescape_hex(source + read + 2, length - read - 2, &code) == 0) {
+            if (strict) {
+              return 0;
+            }
+            // Keep the malformed escape sequence verbatim.
+            consumed = 1;
+            output = source + read;
+            break;
+          }
+          consumed = 6;
+          if (code >= 0xD800 && code <= 0xDFFF) {
+            // Combine a high surrogate with the low surrogate that follows it.
+            uint32_t low = 0;
+            if (code <= 0xDBFF && read + 7 < length && source[read + 6] == '\\' && source[read + 7] == 'u' &&
+                _unescape_hex(source + read + 8, length - read - 8, &low) == 1 && low >= 0xDC00 && low <= 0xDFFF) {
+              code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+              consumed = 12;
+            } else if (strict) {
+              return 0;
+            } else {
+              code = 0xFFFD;
+            }
+          }
+          output_length = _unescape_utf8(code, code_units);
+          break;
+        default:
+          if (strict) {
+            return 0;
+          }
+          // Keep the unknown escape sequence verbatim.
+          consumed = 1;
+          output = source + read;
+          break;
+      }
+    }
+    if (destination != NULL) {
+      memcpy(destination + written, output, output_length);
+    }
+    read += consumed;
+    written += output_length;
+  }
+  *written_length = written;
+  return 1;
+}
@@ -0,0 +1,57 @@
+#ifndef JSON_ESCAPE_H
+#define JSON_ESCAPE_H
+
+#include <stddef.h>
+#include "writer.h"
+
+/**
+ * Appends characters to the writer as a JSON string, enclosed in double quotes.
+ *
+ * Double quotes, backslashes and control characters are escaped. The runs of
+ * characters in between are located 16 or 32 bytes at a time and copied to
+ * the writer as a whole.
+ *
+ * @param struct json_writer* writer
+ *   The writer receiving the encoded characters.
+ * @param const char* characters
+ *   The characters to append.
+ * @param size_t length
+ *   The number of characters to append.
+ *
+ * @return int
+ *   Returns 1 when the encoding succeeded; otherwise, 0.
+ */
+int _json_escape_string(struct json_writer *writer, const char *characters, size_t length);
+
+/**
+ * Resolves the escape sequences of the characters of a JSON string.
+ *
+ * The characters are validated and copied in a single pass. Runs without
+ * escape sequences are located and copied 16 or 32 bytes at a time. \uXXXX
+ * sequences, including surrogate pairs, are written as UTF-8.
+ *
+ * In strict mode malformed UTF-8, control characters, unknown or malformed
+ * escape sequences and unpaired surrogates are rejected. Otherwise non-ASCII
+ * and control characters are copied unchecked, unpaired surrogates become
+ * U+FFFD and malformed escape sequences are kept verbatim.
+ *
+ * The result is never longer than the source.
+ *
+ * @param char* destination
+ *   The destination, at least length bytes long and not overlapping the
+ *   source, or NULL to only validate the characters.
+ * @param const char* source
+ *   The characters between the double quotes of the string.
+ * @param size_t length
+ *   The number of source characters.
+ * @param int strict
+ *   Whether the characters must be valid JSON string content.
+ * @param size_t* written_length
+ *   Receives the number of characters written to the destination.
+ *
+ * @return int
+ *   Returns 1 on success; otherwise, 0 when strict validation failed.
+ */
+int _json_unescape_string(char *destination, const char *source, size_t length, int strict, size_t *written_length);
+
+#endif /* JSON_ESCAPE_H */
@@ -0,0 +1,233 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "allocator.h"
+#include "index.h"
+#include "node.h"
+
+/**
+ * The marker of the slots of removed members.
+ */
+static struct json _index_removed;
+
+/**
+ * {@inheritdoc}
+ */
+size_t _json_index_hash(const char *key, size_t length) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= (unsigned char)key[i];
+    hash *= 1099511628211ULL;
+  }
+  return (size_t)hash;
+}
+
+/**
+ * Adds a member to the free slot of its key, after the members already indexed.
+ *
+ * @param struct json_index* index
+ *   The index instance, with at least one empty slot.
+ * @param struct json* member
+ *   The member to add.
+ */
+static void _index_put(struct json_index *index, struct json *member) {
+  const size_t hash = _json_index_hash(member->key, member->key_length);
+  const size_t mask = index->capacity - 1;
+  size_t slot = hash & mask;
+  while (index->entries[slot].member != NULL) {
+    slot = (slot + 1) & mask;
+  }
+  index->entries[slot].hash = hash;
+  index->entries[slot].member = member;
+}
+
+/**
+ * Returns the number of slots of the index of an object.
+ *
+ * @param size_t count
+ *   The number of members of the object.
+ *
+ * @return size_t
+ *   The number of slots, a power of two.
+ */
+static size_t _index_capacity(size_t count) {
+  // Keep the table at most half full, so that probe sequences stay short.
+  size_t capacity = JSON_INDEX_MIN_MEMBERS * 2;
+  while (capacity < count * 2) {
+    capacity *= 2;
+  }
+  return capacity;
+}
+
+/**
+ * {@inheritdoc}
+ */
+size_t _json_index_size(size_t count) {
+  return sizeof(struct json_index) + _index_capacity(count) * sizeof(struct json_index_entry);
+}
+
+/**
+ * {@inheritdoc}
+ */
+void _json_index_fill(struct json_index *index, size_t count, struct json *first) {
+  index->count = count;
+  index->capacity = _index_capacity(count);
+  index->removed = 0;
+  memset(index->entries, 0, index->capacity * sizeof(struct json_index_entry));
+  for (struct json *member = first; member != NULL; member = member->next) {
+    if (member->key != NULL) {
+      _index_put(index, member);
+    }
+  }
+}
+
+/**
+ * Builds the index of the members of an object chain.
+ *
+ * @param struct json* first
+ *   The first member of the object.
+ *
+ * @return struct json_index*
+ *   The pointer to the index, otherwise NULL.
+ */
+static struct json_index *_index_build(struct json *first) {
+  size_t count = 0;
+  for (struct json *member = first; member != NULL; member = member->next) {
+    count++;
+  }
+  struct json_index *index = (struct json_index *)_json_alloc(NULL, _json_index_size(count));
+  if (index == NULL) {
+    return NULL;
+  }
+  _json_index_fill(index, count, first);
+  return index;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct json_index *_json_index_get(struct json *owner) {
+  // Objects carved from a document arena get their index when decoded, since
+  // nothing would free an index built later on.
+  struct json_index *index = (struct json_index *)_json_children_extension(owner);
+  if (index != NULL || (owner->flags & JSON_FLAG_ARENA) != 0) {
+    return index;
+  }
+  if (_json_children_count(owner) < JSON_INDEX_MIN_MEMBERS) {
+    return NULL;
+  }
+  index = _index_build((struct json *)owner->value);
+  if (index == NULL) {
+    return NULL;
+  }
+  // Publish the index, unless a concurrent search already did.
+  if (_json_children_publish(owner, index) == 0) {
+    _json_free(NULL, index);
+    return (struct json_index *)_json_children_extension(owner);
+  }
+  return index;
+}
+
+/**
+ * Finds the first member of an object with the given key.
+ *
+ * @param struct json* owner
+ *   The node whose value is the first member of the object.
+ * @param const char* key
+ *   The key to find, not necessarily NUL terminated.
+ * @param size_t length
+ *   The number of characters in the key.
+ * @param const size_t* hash
+ *   The hash of the key, or NULL to compute it when needed.
+ *
+ * @return struct json*
+ *   The member with the given key, otherwise NULL.
+ */
+static struct json *_index_find(struct json *owner, const char *key, size_t length, const size_t *hash) {
+  struct json_index *index = _json_index_get(owner);
+  if (index == NULL) {
+    // Search objects without an index linearly.
+    struct json *member = (struct json *)owner->value;
+    while (member != NULL && _json_key_equals(member, key, length) == 0) {
+      member = member->next;
+    }
+    return member;
+  }
+  // Probe the slots of the key.
+  const size_t key_hash = hash != NULL ? *hash : _json_index_hash(key, length);
+  const size_t mask = index->capacity - 1;
+  for (size_t slot = key_hash & mask; index->entries[slot].member != NULL; slot = (slot + 1) & mask) {
+    struct json *member = index->entries[slot].member;
+    if (index->entries[slot].hash == key_hash && member != &_index_removed && member->key_length == length && memcmp(member->key, key, length) == 0) {
+      return member;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct json *_json_index_find(struct json *owner, const char *key, size_t length) {
+  return _index_find(owner, key, length, NULL);
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct json *_json_index_find_hashed(struct json *owner, const char *key, size_t length, size_t hash) {
+  return _index_find(owner, key, length, &hash);
+}
+
+/**
+ * {@inheritdoc}
+ */
+void _json_index_insert(struct json *owner, struct json *member) {
+  struct json_index *index = (struct json_index *)_json_children_extension(owner);
+  if (index == NULL) {
+    return;
+  }
+  index->count++;
+  if (member->key == NULL) {
+    return;
+  }
+  // Rebuild the index once it is three quarters full, counting removed slots.
+  if ((index->count + index->removed) * 4 > index->capacity * 3) {
+    const size_t count = index->count;
+    _json_children_set_count(owner, count);
+    // Indexes carved from a document arena cannot grow; the object is then
+    // searched linearly.
+    if ((owner->flags & JSON_FLAG_ARENA) != 0) {
+      return;
+    }
+    _json_free(NULL, index);
+    index = _index_build((struct json *)owner->value);
+    if (index != NULL) {
+      _json_children_publish(owner, index);
+    }
+    return;
+  }
+  _index_put(index, member);
+}
+
+/**
+ * {@inheritdoc}
+ */
+void _json_index_remove(struct json *owner, struct json *member) {
+  struct json_index *index = (struct json_index *)_json_children_extension(owner);
+  if (index == NULL) {
+    return;
+  }
+  index->count--;
+  if (member->key == NULL) {
+    return;
+  }
+  const size_t mask = index->capacity - 1;
+  for (size_t slot = _json_index_hash(member->key, member->key_length) & mask; index->entries[slot].member != NULL; slot = (slot + 1) & mask) {
+    if (index->entries[slot].member == member) {
+      index->entries[slot].member = &_index_removed;
+      index->removed++;
+      return;
+    }
+  }
+}
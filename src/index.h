@@ -0,0 +1,189 @@
+#ifndef JSON_INDEX_H
+#define JSON_INDEX_H
+
+#include <stddef.h>
+#include "../include/json.h"
+
+/**
+ * The number of members from which an object gets a hash index of its keys.
+ *
+ * Smaller objects are searched linearly, which is faster than hashing the key.
+ */
+#define JSON_INDEX_MIN_MEMBERS 32
+
+/**
+ * The data struct definition for a slot of an object key index.
+ */
+struct json_index_entry {
+
+  /**
+   * The hash of the member key.
+   *
+   * @var size_t hash.
+   */
+  size_t hash;
+
+  /**
+   * The indexed member, NULL for empty slots.
+   *
+   * @var struct json* member.
+   */
+  struct json *member;
+};
+
+/**
+ * The data struct definition for the hash index of the keys of an object.
+ *
+ * The index is an open addressing table with linear probing. Members are
+ * inserted in the order of the object chain and removed slots are never
+ * reused, so among duplicate keys the first member of the chain is found,
+ * just like a linear search would.
+ */
+struct json_index {
+
+  /**
+   * The number of members of the object; see _json_children_count().
+   *
+   * @var size_t count.
+   */
+  size_t count;
+
+  /**
+   * The number of slots, a power of two.
+   *
+   * @var size_t capacity.
+   */
+  size_t capacity;
+
+  /**
+   * The number of slots of removed members.
+   *
+   * @var size_t removed.
+   */
+  size_t removed;
+
+  /**
+   * The slots.
+   *
+   * @var struct json_index_entry entries[].
+   */
+  struct json_index_entry entries[];
+};
+
+/**
+ * Hashes an object key with the 64-bit FNV-1a function.
+ *
+ * @param const char* key
+ *   The key characters.
+ * @param size_t length
+ *   The number of characters in the key.
+ *
+ * @return size_t
+ *   The hash of the key.
+ */
+size_t _json_index_hash(const char *key, size_t length);
+
+/**
+ * Returns the size in bytes of the index of an object.
+ *
+ * @param size_t count
+ *   The number of members of the object.
+ *
+ * @return size_t
+ *   The size in bytes.
+ */
+size_t _json_index_size(size_t count);
+
+/**
+ * Fills an index with the members of an object chain.
+ *
+ * @param struct json_index* index
+ *   The index, of the size returned by _json_index_size() for the count.
+ * @param size_t count
+ *   The number of members of the object.
+ * @param struct json* first
+ *   The first member of the object.
+ */
+void _json_index_fill(struct json_index *index, size_t count, struct json *first);
+
+/**
+ * Returns the index of an object, building it first for large objects.
+ *
+ * The index is published atomically, so concurrent readers may request it
+ * for the same object; objects carved from a document arena are only
+ * indexed when decoded.
+ *
+ * @param struct json* owner
+ *   The node whose value is the first member of the object.
+ *
+ * @return struct json_index*
+ *   The pointer to the index, or NULL for small objects and on allocation
+ *   failure.
+ */
+struct json_index *_json_index_get(struct json *owner);
+
+/**
+ * Finds the first member of an object with the given key.
+ *
+ * Objects with at least JSON_INDEX_MIN_MEMBERS members get a hash index the
+ * first time they are searched, and are searched through it from then on.
+ * The index is published atomically, so concurrent readers may search the
+ * same object.
+ *
+ * @param struct json* owner
+ *   The node whose value is the first member of the object.
+ * @param const char* key
+ *   The key to find, not necessarily NUL terminated.
+ * @param size_t length
+ *   The number of characters in the key.
+ *
+ * @return struct json*
+ *   The member with the given key, otherwise NULL.
+ */
+struct json *_json_index_find(struct json *owner, const char *key, size_t length);
+
+/**
+ * Finds the first member of an object with the given key, whose hash is known.
+ *
+ * @param struct json* owner
+ *   The node whose value is the first member of the object.
+ * @param const char* key
+ *   The key to find, not necessarily NUL terminated.
+ * @param size_t length
+ *   The number of characters in the key.
+ * @param size_t hash
+ *   The hash of the key, as computed by _json_index_hash().
+ *
+ * @return struct json*
+ *   The member with the given key, otherwise NULL.
+ */
+struct json *_json_index_find_hashed(struct json *owner, const char *key, size_t length, size_t hash);
+
+/**
+ * Adds a member, already linked at the end of the object, to the object index.
+ *
+ * Does nothing for objects without an index, whose number of members is kept
+ * by the caller. When the index cannot grow, it is dropped and rebuilt on the
+ * next search.
+ *
+ * @param struct json* owner
+ *   The node whose value is the first member of the object.
+ * @param struct json* member
+ *   The member to add.
+ */
+void _json_index_insert(struct json *owner, struct json *member);
+
+/**
+ * Removes a member from the object index.
+ *
+ * Does nothing for objects without an index, whose number of members is kept
+ * by the caller.
+ *
+ * @param struct json* owner
+ *   The node whose value is the first member of the object.
+ * @param struct json* member
+ *   The member to remove.
+ */
+void _json_index_remove(struct json *owner, struct json *member);
+
+#endif /* JSON_INDEX_H */
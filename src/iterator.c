@@ -1,36 +1,48 @@
 #include <stdlib.h>
 #include <string.h>
 #include <strutils.h>
+#include "allocator.h"
+#include "index.h"
+#include "node.h"
+#include "number.h"
+#include "vector.h"
 #include "../include/json.h"
 
 /**
  * {@inheritdoc}
  */
 struct json* json_find_node(struct json* object, const char* path, const char delimiter) {
-   // Clone the path.
-   char* route = strdup(path);
-   if (route == NULL) {
-      return NULL;
-   }
    // Validates the object type.
-   if (object->type != JSON_object) {
-      free(route);
+   if (object == NULL || path == NULL || object->type != JSON_object) {
       return NULL;
    }
-   // Set the node.
+   // Set the node, and the node whose value is the current chain of members.
    struct json* node = object;
-   // Get the current key.
-   char* key = strtok(route, &delimiter);
-   if (key == NULL) {
-      free(route);
-      return NULL;
-   }
-   // Find the object with the target key.
-   while (key != NULL) {
-      // Check if the current object has the target key.
-      while (node != NULL && strcmp(node->key, key) != 0) {
-         node = node->next;
+   struct json* owner = NULL;
+   // Read the keys in place, skipping empty ones, so that nothing is allocated.
+   int keys = 0;
+   const char* key = path;
+   while (*key != '\0') {
+      if (*key == delimiter) {
+         key++;
+         continue;
+      }
+      const char* end = strchr(key, delimiter);
+      const size_t key_length = end != NULL ? (size_t)(end - key) : strlen(key);
+      // Step into the members of keyless object containers.
+      if (node->key == NULL && node->type == JSON_object) {
+         owner = node;
+         node = (struct json*)node->value;
       }
+      // Check if the current object has the target key, through the key index of large objects.
+      if (owner != NULL && owner->type == JSON_object && owner->value == node) {
+         node = _json_index_find(owner, key, key_length);
+      } else {
+         while (node != NULL && _json_key_equals(node, key, key_length) == 0) {
+            node = node->next;
+         }
+      }
+      owner = node;
       // Set the cursor to the node value.
       if (node != NULL) {
          node = (struct json*)node->value;
@@ -38,34 +50,213 @@ struct json* json_find_node(struct json* object, const char* path, const char de
       // Check if the key was found.
       if (node == NULL) {
          // The given path does not exist in the JSON object.
-         free(route);
          return NULL;
       }
       // Move to the next path token.
-      key = strtok(NULL, &delimiter);
+      keys++;
+      key += key_length;
+   }
+   // Return the target node, if the path had any key.
+   return keys > 0 ? node : NULL;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int json_build_indexes(struct json* object) {
+   if (object == NULL) {
+      return 0;
    }
-   // Free the route.
-   free(route);
-   // Return the target node.
-   return node;
+   // Walk the tree depth first, keeping the next sibling of every open container.
+   struct json** pending = NULL;
+   size_t depth = 0;
+   size_t capacity = 0;
+   int status = 1;
+   struct json* node = object;
+   while (node != NULL || depth > 0) {
+      if (node == NULL) {
+         node = pending[--depth];
+         continue;
+      }
+      struct json* next = node != object ? node->next : NULL;
+      if ((node->type == JSON_object || node->type == JSON_array) && node->value != NULL) {
+         // Build the index or vector the first read would otherwise build.
+         if (node->type == JSON_object && _json_index_get(node) == NULL) {
+            status = status && _json_children_count(node) < JSON_INDEX_MIN_MEMBERS;
+         }
+         if (node->type == JSON_array && _json_vector_get(node) == NULL) {
+            status = status && _json_children_count(node) < JSON_VECTOR_MIN_ELEMENTS;
+         }
+         // Descend into the children, resuming with the next sibling afterwards.
+         if (next != NULL) {
+            if (depth == capacity) {
+               const size_t size = capacity == 0 ? 64 : capacity * 2;
+               struct json** grown = (struct json**)_json_realloc(NULL, pending, size * sizeof(struct json*));
+               if (grown == NULL) {
+                  _json_free(NULL, pending);
+                  return 0;
+               }
+               pending = grown;
+               capacity = size;
+            }
+            pending[depth++] = next;
+         }
+         next = (struct json*)node->value;
+      }
+      node = next;
+   }
+   _json_free(NULL, pending);
+   return status;
 }
 
 /**
  * {@inheritdoc}
  */
 struct json* json_find_node_by_index(struct json* object, const int index) {
-   // JSON require all the index to be strings.
-   char* path = itos(index);
-   if (path == NULL) {
-      return NULL;
+   // Arrays are indexed by position.
+   if (object != NULL && object->type == JSON_array) {
+      return index >= 0 ? json_array_get(object, (size_t)index) : NULL;
    }
+   // JSON require all the object keys to be strings.
+   char path[JSON_NUMBER_BUFFER_SIZE];
+   _json_format_int64(index, path);
    // Find the node.
-   struct json* node = json_find_node(object, path, '.');
-   // Free the memory.
-   free(path);
-   path = NULL;
-   // Return the JSON node.
-   return node;
+   return json_find_node(object, path, '.');
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct json* json_array_get(const struct json* array, size_t index) {
+   if (array == NULL || array->type != JSON_array) {
+      return NULL;
+   }
+   // Read long arrays through their element vector.
+   const struct json_vector* vector = _json_vector_get((struct json*)array);
+   if (vector != NULL) {
+      return index < vector->count ? vector->elements[index] : NULL;
+   }
+   // Walk short arrays.
+   struct json* element = (struct json*)array->value;
+   while (element != NULL && index > 0) {
+      element = element->next;
+      index--;
+   }
+   return element;
+}
+
+/**
+ * {@inheritdoc}
+ */
+size_t json_array_size(const struct json* array) {
+   if (array == NULL || array->type != JSON_array) {
+      return 0;
+   }
+   return _json_children_count(array);
+}
+
+/**
+ * {@inheritdoc}
+ */
+double json_number_value(const struct json *node) {
+  if (node == NULL || node->type != JSON_number) {
+    return 0;
+  }
+  return node->scalar.number;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int64_t json_integer_value(const struct json *node) {
+  if (node == NULL || node->type != JSON_number) {
+    return 0;
+  }
+  // Unsigned integers are above INT64_MAX, so they saturate like doubles do.
+  if ((node->flags & JSON_FLAG_UNSIGNED) != 0) {
+    return INT64_MAX;
+  }
+  if ((node->flags & JSON_FLAG_INTEGER) != 0) {
+    return node->scalar.integer.value;
+  }
+  return _json_double_to_int64(node->scalar.number);
+}
+
+/**
+ * {@inheritdoc}
+ */
+uint64_t json_unsigned_value(const struct json *node) {
+  if (node == NULL || node->type != JSON_number) {
+    return 0;
+  }
+  if ((node->flags & JSON_FLAG_INTEGER) != 0) {
+    return (uint64_t)node->scalar.integer.value;
+  }
+  return _json_double_to_uint64(node->scalar.number);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int json_is_integer(const struct json *node) {
+  return node != NULL && node->type == JSON_number && (node->flags & JSON_FLAG_INTEGER) != 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int json_bool_value(const struct json *node) {
+  if (node == NULL || node->type != JSON_boolean) {
+    return 0;
+  }
+  return node->scalar.boolean;
+}
+
+/**
+ * {@inheritdoc}
+ */
+const char *json_string_value(const struct json *node) {
+  if (node == NULL || node->type != JSON_string) {
+    return NULL;
+  }
+  // Only escaped views are materialized as NUL terminated strings.
+  const unsigned int flags = _json_flags(node);
+  if ((flags & JSON_FLAG_VALUE_VIEW) != 0) {
+    if ((flags & JSON_FLAG_VALUE_ESCAPED) != 0) {
+      return _json_materialize(node);
+    }
+    return NULL;
+  }
+  return (const char *)node->value;
+}
+
+/**
+ * {@inheritdoc}
+ */
+const char *json_string_view(const struct json *node, size_t *length) {
+  if (node == NULL || node->type != JSON_string || node->value == NULL) {
+    return NULL;
+  }
+  // Owned strings are NUL terminated.
+  const unsigned int flags = _json_flags(node);
+  if ((flags & JSON_FLAG_VALUE_VIEW) == 0) {
+    if (length != NULL) {
+      *length = strlen((const char *)node->value);
+    }
+    return (const char *)node->value;
+  }
+  // Escaped views are shorter once materialized, so read the length afterwards.
+  if ((flags & JSON_FLAG_VALUE_ESCAPED) != 0) {
+    const char *text = _json_materialize(node);
+    if (length != NULL) {
+      *length = node->scalar.view.length;
+    }
+    return text;
+  }
+  if (length != NULL) {
+    *length = node->scalar.view.length;
+  }
+  return (const char *)node->value;
 }
 
 /**
@@ -1,24 +1,212 @@
+#include <sched.h>
 #include <stdlib.h>
+#include <string.h>
+#include "allocator.h"
 #include "decoder.h"
 #include "encoder.h"
+#include "escape.h"
+#include "node.h"
+#include "pool.h"
 #include "../include/json.h"
 
+/**
+ * {@inheritdoc}
+ */
+void _json_init(struct json *object, enum JSONDataType type, void *value) {
+  object->next = NULL;
+  object->prev = NULL;
+  object->type = type;
+  object->flags = 0;
+  object->key = NULL;
+  object->key_length = 0;
+  object->value = value;
+  // Numbers and booleans always live in the inline storage.
+  if (type == JSON_number) {
+    object->scalar.number = 0;
+    object->value = &object->scalar;
+  } else if (type == JSON_boolean) {
+    object->scalar.boolean = 0;
+    object->value = &object->scalar;
+  } else if (type == JSON_object || type == JSON_array) {
+    // Chains given up front have to be walked to find their tail.
+    object->scalar.children.tail = NULL;
+    object->scalar.children.state = value == NULL ? JSON_CHILDREN_COUNT(0) : JSON_CHILDREN_UNKNOWN;
+  }
+}
+
+/**
+ * {@inheritdoc}
+ */
+size_t _json_children_count(const struct json *container) {
+  const uintptr_t state = __atomic_load_n(&container->scalar.children.state, __ATOMIC_ACQUIRE);
+  if ((state & 1) != 0) {
+    return (size_t)(state >> 1);
+  }
+  if (state != JSON_CHILDREN_UNKNOWN) {
+    return *(const size_t *)state;
+  }
+  size_t count = 0;
+  for (const struct json *child = (const struct json *)container->value; child != NULL; child = child->next) {
+    count++;
+  }
+  return count;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void *_json_children_extension(const struct json *container) {
+  const uintptr_t state = __atomic_load_n(&container->scalar.children.state, __ATOMIC_ACQUIRE);
+  return (state & 1) == 0 ? (void *)state : NULL;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int _json_children_publish(struct json *container, void *extension) {
+  uintptr_t state = __atomic_load_n(&container->scalar.children.state, __ATOMIC_ACQUIRE);
+  while ((state & 1) != 0 || state == JSON_CHILDREN_UNKNOWN) {
+    if (__atomic_compare_exchange_n(&container->scalar.children.state, &state, (uintptr_t)extension, 0, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void _json_children_set_extension(struct json *container, void *extension) {
+  __atomic_store_n(&container->scalar.children.state, (uintptr_t)extension, __ATOMIC_RELEASE);
+}
+
+/**
+ * {@inheritdoc}
+ */
+void _json_children_set_count(struct json *container, size_t count) {
+  __atomic_store_n(&container->scalar.children.state, JSON_CHILDREN_COUNT(count), __ATOMIC_RELEASE);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int _json_inline_string(struct json *object, const char *string, size_t length) {
+  if (length >= JSON_INLINE_STRING_SIZE) {
+    return 0;
+  }
+  memcpy(object->scalar.string, string, length);
+  object->scalar.string[length] = '\0';
+  object->value = object->scalar.string;
+  return 1;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int _json_owns_value(const struct json *object) {
+  if ((object->flags & JSON_FLAG_VALUE_VIEW) != 0) {
+    return 0;
+  }
+  return object->value != NULL && object->value != (const void *)&object->scalar;
+}
+
+/**
+ * {@inheritdoc}
+ */
+char *_json_alloc_string(struct json *object, size_t length, unsigned int flag) {
+  char *buffer = (char *)_json_pool_alloc(length + 1);
+  if (buffer != NULL && length < JSON_POOL_MAX_SIZE) {
+    object->flags |= flag;
+  }
+  return buffer;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void _json_free_string(struct json *object, char *buffer, unsigned int flag) {
+  if ((object->flags & flag) != 0) {
+    _json_pool_free(buffer);
+    object->flags &= ~flag;
+  } else {
+    _json_free(NULL, buffer);
+  }
+}
+
+/**
+ * {@inheritdoc}
+ */
+int _json_key_equals(const struct json *object, const char *key, size_t length) {
+  if (object->key == NULL) {
+    return 0;
+  }
+  // Compare by length, as the key index does, since views are not NUL
+  // terminated and decoded keys may hold escaped NUL characters.
+  return object->key_length == length && memcmp(object->key, key, length) == 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+unsigned int _json_flags(const struct json *object) {
+  return __atomic_load_n(&object->flags, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * Backs off while another thread materializes a string view.
+ */
+static void _json_materialize_wait(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#else
+  sched_yield();
+#endif
+}
+
+/**
+ * {@inheritdoc}
+ */
+const char *_json_materialize(const struct json *object) {
+  struct json *node = (struct json *)object;
+  unsigned int flags = __atomic_load_n(&node->flags, __ATOMIC_ACQUIRE);
+  while ((flags & JSON_FLAG_VALUE_MATERIALIZED) == 0) {
+    // Claim the materialization, or wait for the thread that claimed it.
+    if ((flags & JSON_FLAG_VALUE_MATERIALIZING) == 0 &&
+        __atomic_compare_exchange_n(&node->flags, &flags, flags | JSON_FLAG_VALUE_MATERIALIZING, 0, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+      size_t length = 0;
+      _json_unescape_string(node->scalar.view.text, (const char *)node->value, node->scalar.view.length, 0, &length);
+      node->scalar.view.text[length] = '\0';
+      node->scalar.view.length = length;
+      __atomic_fetch_or(&node->flags, JSON_FLAG_VALUE_MATERIALIZED, __ATOMIC_RELEASE);
+      break;
+    }
+    if ((flags & JSON_FLAG_VALUE_MATERIALIZING) != 0) {
+      _json_materialize_wait();
+    }
+    flags = __atomic_load_n(&node->flags, __ATOMIC_ACQUIRE);
+  }
+  return node->scalar.view.text;
+}
+
 /**
  * {@inheritdoc}
  */
 struct json *json_create(enum JSONDataType type, void *value) {
-  // Allocate JSON object memory.
-  size_t size = sizeof(struct json);
-  struct json *json_object = (struct json *)malloc(size);
+  // Allocate JSON object memory from the pool of the calling thread.
+  struct json *json_object = (struct json *)_json_pool_alloc(sizeof(struct json));
   if (json_object == NULL) {
     return NULL;
   }
   // Init JSON object properties.
-  json_object->next = NULL;
-  json_object->prev = NULL;
-  json_object->type = type;
-  json_object->key = NULL;
-  json_object->value = value;
+  _json_init(json_object, type, value);
+  // Move scalar values into the inline storage.
+  if (type == JSON_number && value != NULL) {
+    json_object->scalar.number = *(double *)value;
+    _json_free(NULL, value);
+  } else if (type == JSON_boolean && value != NULL) {
+    json_object->scalar.boolean = *(int *)value;
+    _json_free(NULL, value);
+  }
   // Return the JSON object.
   return json_object;
 }
@@ -27,27 +215,43 @@ struct json *json_create(enum JSONDataType type, void *value) {
  * {@inheritdoc}
  */
 void json_destroy(struct json *object) {
-  // Base case: if the object is NULL, nothing to do
-  if (object == NULL) {
-    // Uninitialized JSON object.
-    return;
-  }
-  // Recursively destroy the next object in the chain.
-  if (object->next != NULL) {
-    json_destroy(object->next);
-  }
-  // Free the key if it's not NULL
-  if (object->key != NULL) {
-    free(object->key);
-    object->key = NULL;
-  }
-  // Free the value if it's not NULL
-  if (object->value != NULL) {
-    free(object->value);
-    object->value = NULL;
+  // Walk the chain of nodes pending destruction.
+  while (object != NULL) {
+    // Splice the children of containers into the pending chain, so that
+    // nesting is flattened instead of recursed into.
+    if ((object->type == JSON_object || object->type == JSON_array) && object->value != NULL) {
+      struct json *child = (struct json *)object->value;
+      struct json *tail = child;
+      while (tail->next != NULL) {
+        tail = tail->next;
+      }
+      tail->next = object->next;
+      object->next = child;
+      object->value = NULL;
+    }
+    struct json *next = object->next;
+    // Free the key if it's not NULL and not a view.
+    if (object->key != NULL && (object->flags & JSON_FLAG_KEY_VIEW) == 0) {
+      _json_free_string(object, object->key, JSON_FLAG_KEY_POOLED);
+      object->key = NULL;
+    }
+    // Free the value if it's not NULL and not stored inline.
+    if (_json_owns_value(object)) {
+      _json_free_string(object, (char *)object->value, JSON_FLAG_VALUE_POOLED);
+      object->value = NULL;
+    }
+    // Free the key index of large objects and the element vector of long arrays.
+    if (object->type == JSON_object || object->type == JSON_array) {
+      _json_free(NULL, _json_children_extension(object));
+    }
+    // Free the buffer reserved to materialize escaped views.
+    if ((object->flags & JSON_FLAG_VALUE_ESCAPED) != 0) {
+      _json_free(NULL, object->scalar.view.text);
+    }
+    // Return the object itself to the pool.
+    _json_pool_free(object);
+    object = next;
   }
-  // Free the object itself.
-  free(object);
 }
 
 /**
@@ -69,15 +273,42 @@ void json_destroy_multiple(struct json **items, int size) {
  * {@inheritdoc}
  */
 struct json *json_decode(const char *json_string) {
-  // Init the String Tokenizer instance.
-  struct StringTokenizer *tokenizer = st_create((char *)json_string);
-  if (tokenizer == NULL) {
+  return json_decode_with_options(json_string, NULL);
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct json *json_decode_with_options(const char *json_string, const struct json_decode_options *options) {
+  if (json_string == NULL) {
+    return NULL;
+  }
+  return json_decode_n(json_string, strlen(json_string), NULL, options);
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct json *json_decode_n(const char *buffer, size_t length, size_t *offset, const struct json_decode_options *options) {
+  if (buffer == NULL) {
     return NULL;
   }
-  // Try to decode the JSON string.
-  struct json *json_object = _decode_json(tokenizer);
-  // Free the tokenizer memory.
-  st_destroy(tokenizer);
+  // Init the decoder instance.
+  struct json_decoder decoder;
+  _decoder_init(&decoder, buffer, length, NULL);
+  if (options != NULL && options->max_depth > 0) {
+    decoder.max_depth = options->max_depth;
+  }
+  if (options != NULL) {
+    decoder.flags = options->flags;
+    decoder.allocator = options->allocator;
+  }
+  // Try to decode the JSON buffer.
+  struct json *json_object = _decode_json(&decoder);
+  // Report where decoding stopped.
+  if (offset != NULL) {
+    *offset = json_object != NULL ? decoder.position + 1 : decoder.position;
+  }
   // Return the decoded JSON object.
   return json_object;
 }
@@ -86,20 +317,119 @@ struct json *json_decode(const char *json_string) {
  * {@inheritdoc}
  */
 char *json_encode(struct json *object) {
-  // Init the String Tokenizer instance.
-  struct StringTokenizer *tokenizer = st_create_empty(100);
-  if (tokenizer == NULL) {
+  return json_encode_with_options(object, NULL);
+}
+
+/**
+ * {@inheritdoc}
+ */
+char *json_encode_with_options(struct json *object, const struct json_encode_options *options) {
+  // Init a writer collecting the characters in a growing string.
+  struct json_writer writer;
+  if (_writer_init(&writer, NULL, options != NULL ? options->allocator : NULL) == 0) {
     return NULL;
   }
   // Try to encode the JSON object.
-  if (_encode_json(object, tokenizer) == 0) {
-    // Free the tokenizer memory.
-    st_destroy(tokenizer);
+  if (_encode_json_with_options(object, &writer, options, 0) == 0 || _writer_finish(&writer) == 0) {
+    _writer_release(&writer);
     return NULL;
   }
-  char *json_string = tokenizer->string;
-  // Free the tokenizer memory.
-  st_destroy(tokenizer);
-  // Return the decoded JSON object.
-  return json_string;
+  // Return the encoded JSON string.
+  return writer.buffer;
+}
+
+/**
+ * {@inheritdoc}
+ */
+char *json_encode_exact(struct json *object) {
+  // Measure the encoded characters, to allocate the string once.
+  const size_t size = json_encoded_size(object);
+  if (size == 0) {
+    return NULL;
+  }
+  char *buffer = (char *)_json_alloc(NULL, size + 1);
+  if (buffer == NULL) {
+    return NULL;
+  }
+  // Encode the JSON object straight into the string.
+  if (json_encode_into(object, buffer, size + 1) != size) {
+    _json_free(NULL, buffer);
+    return NULL;
+  }
+  return buffer;
+}
+
+/**
+ * {@inheritdoc}
+ */
+size_t json_encoded_size(struct json *object) {
+  struct json_sink sink = json_sink_count();
+  return json_encode_to(object, &sink) == 1 ? sink.length : 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+size_t json_encode_into(struct json *object, char *buffer, size_t capacity) {
+  struct json_sink sink = json_sink_buffer(buffer, capacity);
+  return json_encode_to(object, &sink) == 1 ? sink.length : 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct json_sink json_sink_callback(int (*write)(void *context, const char *data, size_t length), void *context) {
+  struct json_sink sink = {JSON_SINK_CALLBACK, write, context, -1, NULL, 0, 0};
+  return sink;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct json_sink json_sink_fd(int fd) {
+  struct json_sink sink = {JSON_SINK_FD, NULL, NULL, fd, NULL, 0, 0};
+  return sink;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct json_sink json_sink_buffer(char *buffer, size_t capacity) {
+  struct json_sink sink = {JSON_SINK_BUFFER, NULL, NULL, -1, buffer, capacity, 0};
+  return sink;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct json_sink json_sink_count() {
+  struct json_sink sink = {JSON_SINK_COUNT, NULL, NULL, -1, NULL, 0, 0};
+  return sink;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int json_encode_to(struct json *object, struct json_sink *sink) {
+  return json_encode_to_with_options(object, sink, NULL);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int json_encode_to_with_options(struct json *object, struct json_sink *sink, const struct json_encode_options *options) {
+  if (sink == NULL) {
+    return 0;
+  }
+  // Init a writer batching the characters for the sink.
+  struct json_writer writer;
+  if (_writer_init(&writer, sink, options != NULL ? options->allocator : NULL) == 0) {
+    return 0;
+  }
+  // Try to encode the JSON object.
+  if (_encode_json_with_options(object, &writer, options, 0) == 0) {
+    _writer_release(&writer);
+    return 0;
+  }
+  return _writer_finish(&writer);
 }
@@ -0,0 +1,260 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "allocator.h"
+#include "decoder.h"
+#include "lines.h"
+
+/**
+ * Checks whether the given characters are all whitespaces.
+ *
+ * @param const char* characters
+ *   The characters to check.
+ * @param size_t length
+ *   The number of characters.
+ *
+ * @return int
+ *   Returns 1 when every character is a whitespace; otherwise, 0.
+ */
+static int _lines_is_blank(const char *characters, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    if (characters[i] != ' ' && characters[i] != '\t' && characters[i] != '\r' && characters[i] != '\n') {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**
+ * Decodes a single record into the worker arena.
+ *
+ * @param struct json_lines_worker* worker
+ *   The worker instance.
+ * @param const char* line
+ *   The line characters.
+ * @param size_t length
+ *   The number of characters in the line.
+ *
+ * @return struct json*
+ *   The decoded record, or NULL when the line is not a single JSON value.
+ */
+static struct json *_lines_decode_record(struct json_lines_worker *worker, const char *line, size_t length) {
+  const struct json_decode_options *options = worker->pool->options;
+  struct json_decoder decoder;
+  _decoder_init(&decoder, line, length, &worker->arena);
+  if (options != NULL && options->max_depth > 0) {
+    decoder.max_depth = options->max_depth;
+  }
+  if (options != NULL) {
+    decoder.flags = options->flags;
+  }
+  struct json *record = _decode_json(&decoder);
+  // Reject anything but whitespaces after the value.
+  if (record == NULL || _lines_is_blank(line + decoder.position + 1, length - decoder.position - 1) == 0) {
+    return NULL;
+  }
+  return record;
+}
+
+/**
+ * Decodes every line of the worker batch.
+ *
+ * @param struct json_lines_worker* worker
+ *   The worker instance.
+ */
+static void _lines_decode_batch(struct json_lines_worker *worker) {
+  // Reuse the memory of the previous batch.
+  _arena_reset(&worker->arena);
+  worker->count = 0;
+  worker->line_count = 0;
+  worker->failed = 0;
+  size_t position = 0;
+  while (position < worker->length) {
+    // Find the end of the line.
+    const char *line = worker->start + position;
+    const char *newline = (const char *)memchr(line, '\n', worker->length - position);
+    const size_t length = newline != NULL ? (size_t)(newline - line) : worker->length - position;
+    if (_lines_is_blank(line, length) == 0) {
+      // Grow the record arrays when they are full.
+      if (worker->count == worker->capacity) {
+        size_t capacity = worker->capacity == 0 ? 1024 : worker->capacity * 2;
+        struct json **records = (struct json **)_json_realloc(worker->arena.allocator, worker->records, capacity * sizeof(struct json *));
+        if (records != NULL) {
+          worker->records = records;
+        }
+        size_t *lines = (size_t *)_json_realloc(worker->arena.allocator, worker->lines, capacity * sizeof(size_t));
+        if (lines != NULL) {
+          worker->lines = lines;
+        }
+        if (records == NULL || lines == NULL) {
+          worker->failed = 1;
+          return;
+        }
+        worker->capacity = capacity;
+      }
+      worker->records[worker->count] = _lines_decode_record(worker, line, length);
+      worker->lines[worker->count] = worker->line_count;
+      worker->count++;
+    }
+    worker->line_count++;
+    position += length + 1;
+  }
+}
+
+/**
+ * Runs a worker thread, decoding a batch on every round of the pool.
+ *
+ * @param void* argument
+ *   The worker instance.
+ *
+ * @return void*
+ *   Always NULL.
+ */
+static void *_lines_worker_run(void *argument) {
+  struct json_lines_worker *worker = (struct json_lines_worker *)argument;
+  struct json_lines_pool *pool = worker->pool;
+  size_t round = 0;
+  pthread_mutex_lock(&pool->mutex);
+  while (1) {
+    // Wait for the next round.
+    while (pool->stop == 0 && pool->round == round) {
+      pthread_cond_wait(&pool->start, &pool->mutex);
+    }
+    if (pool->stop) {
+      break;
+    }
+    round = pool->round;
+    pthread_mutex_unlock(&pool->mutex);
+    _lines_decode_batch(worker);
+    pthread_mutex_lock(&pool->mutex);
+    // Wake the calling thread up once the round is done.
+    pool->running--;
+    if (pool->running == 0) {
+      pthread_cond_signal(&pool->done);
+    }
+  }
+  pthread_mutex_unlock(&pool->mutex);
+  return NULL;
+}
+
+/**
+ * Gives every worker its next batch of lines.
+ *
+ * @param struct json_lines_pool* pool
+ *   The pool instance.
+ * @param const char* buffer
+ *   The newline-delimited JSON records.
+ * @param size_t length
+ *   The number of characters in the buffer.
+ * @param size_t offset
+ *   The offset of the first character not yet given to a worker.
+ *
+ * @return size_t
+ *   The offset of the first character left for the next round.
+ */
+static size_t _lines_assign_batches(struct json_lines_pool *pool, const char *buffer, size_t length, size_t offset) {
+  for (size_t i = 0; i < pool->count; i++) {
+    struct json_lines_worker *worker = &pool->workers[i];
+    size_t size = length - offset < JSON_LINES_BATCH_SIZE ? length - offset : JSON_LINES_BATCH_SIZE;
+    // Extend the batch to the end of its last line.
+    if (offset + size < length) {
+      const char *newline = (const char *)memchr(buffer + offset + size, '\n', length - offset - size);
+      size = newline != NULL ? (size_t)(newline - buffer) + 1 - offset : length - offset;
+    }
+    worker->start = buffer + offset;
+    worker->length = size;
+    offset += size;
+  }
+  return offset;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int json_decode_lines(const char *buffer, size_t length, const struct json_lines_options *options, int (*on_record)(void *context, size_t line, struct json *record), void *context) {
+  if (buffer == NULL || on_record == NULL) {
+    return 0;
+  }
+  // Use a thread per online processor by default, and no more than needed.
+  size_t threads = options != NULL ? options->threads : 0;
+  if (threads == 0) {
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = processors > 0 ? (size_t)processors : 1;
+  }
+  if (threads > length / JSON_LINES_BATCH_SIZE + 1) {
+    threads = length / JSON_LINES_BATCH_SIZE + 1;
+  }
+  // Init the pool, whose batches come from the allocator of the options.
+  const struct json_allocator *allocator = options != NULL ? options->decode.allocator : NULL;
+  struct json_lines_pool pool;
+  pool.workers = (struct json_lines_worker *)_json_calloc(allocator, threads, sizeof(struct json_lines_worker));
+  if (pool.workers == NULL) {
+    return 0;
+  }
+  pthread_mutex_init(&pool.mutex, NULL);
+  pthread_cond_init(&pool.start, NULL);
+  pthread_cond_init(&pool.done, NULL);
+  pool.round = 0;
+  pool.running = 0;
+  pool.stop = 0;
+  pool.options = options != NULL ? &options->decode : NULL;
+  pool.count = 1;
+  for (size_t i = 0; i < threads; i++) {
+    pool.workers[i].pool = &pool;
+    _arena_init(&pool.workers[i].arena, allocator);
+  }
+  // Start the worker threads; the calling thread is the first worker.
+  while (pool.count < threads) {
+    if (pthread_create(&pool.workers[pool.count].thread, NULL, _lines_worker_run, &pool.workers[pool.count]) != 0) {
+      break;
+    }
+    pool.count++;
+  }
+  int status = 1;
+  size_t offset = 0;
+  size_t line_base = 0;
+  while (status == 1 && offset < length) {
+    offset = _lines_assign_batches(&pool, buffer, length, offset);
+    // Decode a batch per worker.
+    pthread_mutex_lock(&pool.mutex);
+    pool.round++;
+    pool.running = pool.count - 1;
+    pthread_cond_broadcast(&pool.start);
+    pthread_mutex_unlock(&pool.mutex);
+    _lines_decode_batch(&pool.workers[0]);
+    pthread_mutex_lock(&pool.mutex);
+    while (pool.running > 0) {
+      pthread_cond_wait(&pool.done, &pool.mutex);
+    }
+    pthread_mutex_unlock(&pool.mutex);
+    // Report the records in input order.
+    for (size_t i = 0; status == 1 && i < pool.count; i++) {
+      struct json_lines_worker *worker = &pool.workers[i];
+      for (size_t j = 0; status == 1 && j < worker->count; j++) {
+        status = on_record(context, line_base + worker->lines[j], worker->records[j]) == 1;
+      }
+      if (worker->failed) {
+        status = 0;
+      }
+      line_base += worker->line_count;
+    }
+  }
+  // Stop the worker threads.
+  pthread_mutex_lock(&pool.mutex);
+  pool.stop = 1;
+  pthread_cond_broadcast(&pool.start);
+  pthread_mutex_unlock(&pool.mutex);
+  for (size_t i = 0; i < threads; i++) {
+    if (i > 0 && i < pool.count) {
+      pthread_join(pool.workers[i].thread, NULL);
+    }
+    _arena_release(&pool.workers[i].arena);
+    _json_free(allocator, pool.workers[i].records);
+    _json_free(allocator, pool.workers[i].lines);
+  }
+  pthread_cond_destroy(&pool.done);
+  pthread_cond_destroy(&pool.start);
+  pthread_mutex_destroy(&pool.mutex);
+  _json_free(allocator, pool.workers);
+  return status;
+}
@@ -0,0 +1,169 @@
+#ifndef JSON_LINES_INTERNAL_H
+#define JSON_LINES_INTERNAL_H
+
+#include <pthread.h>
+#include "arena.h"
+#include "../include/json.h"
+
+/**
+ * The number of input bytes given to a worker at once.
+ *
+ * Batches are extended to the end of their last line.
+ */
+#define JSON_LINES_BATCH_SIZE 1048576
+
+struct json_lines_pool;
+
+/**
+ * The data struct definition for a worker decoding batches of records.
+ */
+struct json_lines_worker {
+
+  /**
+   * The pool the worker belongs to.
+   *
+   * @var struct json_lines_pool* pool.
+   */
+  struct json_lines_pool *pool;
+
+  /**
+   * The worker thread.
+   *
+   * @var pthread_t thread.
+   */
+  pthread_t thread;
+
+  /**
+   * The arena owning the records decoded by the worker.
+   *
+   * @var struct json_arena arena.
+   */
+  struct json_arena arena;
+
+  /**
+   * The first character of the batch.
+   *
+   * @var const char* start.
+   */
+  const char *start;
+
+  /**
+   * The number of characters in the batch.
+   *
+   * @var size_t length.
+   */
+  size_t length;
+
+  /**
+   * The decoded records of the batch, NULL for invalid lines.
+   *
+   * @var struct json** records.
+   */
+  struct json **records;
+
+  /**
+   * The line numbers of the records, relative to the batch.
+   *
+   * @var size_t* lines.
+   */
+  size_t *lines;
+
+  /**
+   * The number of records in the batch.
+   *
+   * @var size_t count.
+   */
+  size_t count;
+
+  /**
+   * The number of records the arrays can hold before growing.
+   *
+   * @var size_t capacity.
+   */
+  size_t capacity;
+
+  /**
+   * The number of lines in the batch, including blank ones.
+   *
+   * @var size_t line_count.
+   */
+  size_t line_count;
+
+  /**
+   * Whether the batch could not be decoded for lack of memory.
+   *
+   * @var int failed.
+   */
+  int failed;
+};
+
+/**
+ * The data struct definition for a pool of workers decoding records.
+ */
+struct json_lines_pool {
+
+  /**
+   * Guards the round and running counters.
+   *
+   * @var pthread_mutex_t mutex.
+   */
+  pthread_mutex_t mutex;
+
+  /**
+   * Signaled when a new round of batches starts or the pool stops.
+   *
+   * @var pthread_cond_t start.
+   */
+  pthread_cond_t start;
+
+  /**
+   * Signaled when the last worker of a round is done.
+   *
+   * @var pthread_cond_t done.
+   */
+  pthread_cond_t done;
+
+  /**
+   * The number of rounds started.
+   *
+   * @var size_t round.
+   */
+  size_t round;
+
+  /**
+   * The number of worker threads still decoding the current round.
+   *
+   * @var size_t running.
+   */
+  size_t running;
+
+  /**
+   * Whether the worker threads must exit.
+   *
+   * @var int stop.
+   */
+  int stop;
+
+  /**
+   * The options used to decode every record.
+   *
+   * @var const struct json_decode_options* options.
+   */
+  const struct json_decode_options *options;
+
+  /**
+   * The workers; the first one runs on the calling thread.
+   *
+   * @var struct json_lines_worker* workers.
+   */
+  struct json_lines_worker *workers;
+
+  /**
+   * The number of workers.
+   *
+   * @var size_t count.
+   */
+  size_t count;
+};
+
+#endif /* JSON_LINES_INTERNAL_H */
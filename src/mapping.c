@@ -0,0 +1,94 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "allocator.h"
+#include "mapping.h"
+
+/**
+ * {@inheritdoc}
+ */
+int _json_map_file(const char *filepath, struct json_mapping *mapping) {
+  mapping->next = NULL;
+  mapping->data = NULL;
+  mapping->length = 0;
+  int fd = open(filepath, O_RDONLY);
+  if (fd < 0) {
+    return 0;
+  }
+  // Only non-empty regular files can be mapped.
+  struct stat info;
+  if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size <= 0) {
+    close(fd);
+    return 0;
+  }
+  void *data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping stays valid once the file descriptor is closed.
+  close(fd);
+  if (data == MAP_FAILED) {
+    return 0;
+  }
+  // The decoder reads the mapping front to back; the advice is best effort.
+  madvise(data, (size_t)info.st_size, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+  madvise(data, (size_t)info.st_size, MADV_HUGEPAGE);
+#endif
+  mapping->data = (char *)data;
+  mapping->length = (size_t)info.st_size;
+  return 1;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void _json_unmap_file(struct json_mapping *mapping) {
+  if (mapping->data != NULL) {
+    munmap(mapping->data, mapping->length);
+  }
+  mapping->data = NULL;
+  mapping->length = 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+char *_json_read_file(const char *filepath, const struct json_allocator *allocator, size_t *length) {
+  int fd = open(filepath, O_RDONLY);
+  if (fd < 0) {
+    return NULL;
+  }
+  // Start from the size of regular files, and grow geometrically otherwise.
+  struct stat info;
+  size_t capacity = fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0 ? (size_t)info.st_size + 1 : 4096;
+  char *buffer = (char *)_json_alloc(allocator, capacity);
+  size_t size = 0;
+  while (buffer != NULL) {
+    if (size + 1 == capacity) {
+      char *grown = (char *)_json_realloc(allocator, buffer, capacity * 2);
+      if (grown == NULL) {
+        _json_free(allocator, buffer);
+        buffer = NULL;
+        break;
+      }
+      buffer = grown;
+      capacity *= 2;
+    }
+    const ssize_t count = read(fd, buffer + size, capacity - size - 1);
+    if (count > 0) {
+      size += (size_t)count;
+    } else if (count == 0) {
+      break;
+    } else if (errno != EINTR) {
+      _json_free(allocator, buffer);
+      buffer = NULL;
+    }
+  }
+  close(fd);
+  if (buffer == NULL) {
+    return NULL;
+  }
+  buffer[size] = '\0';
+  *length = size;
+  return buffer;
+}
@@ -0,0 +1,77 @@
+#ifndef JSON_MAPPING_H
+#define JSON_MAPPING_H
+
+#include <stddef.h>
+#include "../include/json.h"
+
+/**
+ * The data struct definition for a read-only memory mapping of a file.
+ */
+struct json_mapping {
+
+  /**
+   * Pointer to the next mapping owned by the same document.
+   *
+   * @var struct json_mapping* next.
+   */
+  struct json_mapping *next;
+
+  /**
+   * The mapped file contents.
+   *
+   * @var char* data.
+   */
+  char *data;
+
+  /**
+   * The number of mapped bytes.
+   *
+   * @var size_t length.
+   */
+  size_t length;
+};
+
+/**
+ * Maps the given file into memory for sequential reading.
+ *
+ * The kernel is advised that the mapping is read sequentially and, where
+ * available, that it may be backed by huge pages.
+ *
+ * @param const char* filepath
+ *   The path of the file to map.
+ * @param struct json_mapping* mapping
+ *   Receives the mapping.
+ *
+ * @return int
+ *   Returns 1 when the file was mapped; otherwise, 0 (e.g. empty files, pipes
+ *   or special files that cannot be mapped).
+ */
+int _json_map_file(const char *filepath, struct json_mapping *mapping);
+
+/**
+ * Releases a memory mapping created by _json_map_file().
+ *
+ * @param struct json_mapping* mapping
+ *   The mapping to release.
+ */
+void _json_unmap_file(struct json_mapping *mapping);
+
+/**
+ * Reads the whole contents of the given file into a buffer.
+ *
+ * Used for the files that cannot be mapped, such as pipes.
+ *
+ * @param const char* filepath
+ *   The path of the file to read.
+ * @param const struct json_allocator* allocator
+ *   The allocator of the buffer, or NULL for the default allocator.
+ * @param size_t* length
+ *   Receives the number of characters read.
+ *
+ * @return char*
+ *   The NUL terminated contents, to be released with the allocator, otherwise
+ *   NULL.
+ */
+char *_json_read_file(const char *filepath, const struct json_allocator *allocator, size_t *length);
+
+#endif /* JSON_MAPPING_H */
@@ -0,0 +1,221 @@
+#ifndef JSON_NODE_H
+#define JSON_NODE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../include/json.h"
+
+/**
+ * Node flag: a thread is materializing the escaped string view.
+ */
+#define JSON_FLAG_VALUE_MATERIALIZING 0x100
+
+/**
+ * Node flag: the escaped string view has been materialized into scalar.view.text.
+ */
+#define JSON_FLAG_VALUE_MATERIALIZED 0x200
+
+/**
+ * Node flag: the node is carved from a document arena and must not be freed.
+ */
+#define JSON_FLAG_ARENA 0x400
+
+/**
+ * Node flag: the key was allocated from the node pool.
+ */
+#define JSON_FLAG_KEY_POOLED 0x800
+
+/**
+ * Node flag: the string value was allocated from the node pool.
+ */
+#define JSON_FLAG_VALUE_POOLED 0x1000
+
+/**
+ * The state of containers whose number of children is unknown.
+ *
+ * Other states are either a number of children, tagged by JSON_CHILDREN_COUNT(),
+ * or the pointer to a struct json_index or struct json_vector.
+ */
+#define JSON_CHILDREN_UNKNOWN ((uintptr_t)0)
+
+/**
+ * Tags a number of children as a container state, setting its low bit.
+ */
+#define JSON_CHILDREN_COUNT(count) (((uintptr_t)(count) << 1) | 1)
+
+/**
+ * Returns the number of children of a JSON object or array.
+ *
+ * The number is read from the node, or from its key index or element vector,
+ * which start with it. It is only counted when unknown, for value chains not
+ * built through json_push().
+ *
+ * @param const struct json* container
+ *   The JSON object or array.
+ *
+ * @return size_t
+ *   The number of children.
+ */
+size_t _json_children_count(const struct json *container);
+
+/**
+ * Returns the key index (objects) or element vector (arrays) of a container.
+ *
+ * @param const struct json* container
+ *   The JSON object or array.
+ *
+ * @return void*
+ *   The struct json_index or struct json_vector, otherwise NULL.
+ */
+void *_json_children_extension(const struct json *container);
+
+/**
+ * Publishes the key index or element vector of a container, built by a reader.
+ *
+ * @param struct json* container
+ *   The JSON object or array.
+ * @param void* extension
+ *   The struct json_index or struct json_vector, holding the number of children.
+ *
+ * @return int
+ *   Returns 1 when it was published; otherwise, 0 when another one was first.
+ */
+int _json_children_publish(struct json *container, void *extension);
+
+/**
+ * Replaces the key index or element vector of a container, while modifying it.
+ *
+ * @param struct json* container
+ *   The JSON object or array.
+ * @param void* extension
+ *   The struct json_index or struct json_vector, holding the number of children.
+ */
+void _json_children_set_extension(struct json *container, void *extension);
+
+/**
+ * Stores the number of children of a container, dropping its key index or element vector.
+ *
+ * @param struct json* container
+ *   The JSON object or array.
+ * @param size_t count
+ *   The number of children.
+ */
+void _json_children_set_count(struct json *container, size_t count);
+
+/**
+ * Initializes the properties of a JSON node.
+ *
+ * @param struct json* object
+ *   The JSON node to initialize.
+ * @param enum JSONDataType type
+ *   The Supported JSON Data Type.
+ * @param void* value
+ *   The pointer value.
+ */
+void _json_init(struct json *object, enum JSONDataType type, void *value);
+
+/**
+ * Stores the given string in the inline storage of a JSON string node.
+ *
+ * @param struct json* object
+ *   The JSON string node.
+ * @param const char* string
+ *   The characters to store.
+ * @param size_t length
+ *   The number of characters to store.
+ *
+ * @return int
+ *   Returns 1 when the string fits in the inline storage and was stored; otherwise, 0.
+ */
+int _json_inline_string(struct json *object, const char *string, size_t length);
+
+/**
+ * Checks whether the value of a JSON node is a separate allocation.
+ *
+ * @param const struct json* object
+ *   The JSON node.
+ *
+ * @return int
+ *   Returns 1 when the value must be freed separately from the node; otherwise, 0.
+ */
+int _json_owns_value(const struct json *object);
+
+/**
+ * Allocates the buffer of a key or string of a JSON node.
+ *
+ * Short buffers come from the pool of the calling thread, in which case the
+ * given flag is set on the node, so that json_destroy() returns them to it.
+ *
+ * @param struct json* object
+ *   The JSON node the buffer belongs to.
+ * @param size_t length
+ *   The number of characters, not counting the NUL terminator.
+ * @param unsigned int flag
+ *   JSON_FLAG_KEY_POOLED or JSON_FLAG_VALUE_POOLED.
+ *
+ * @return char*
+ *   The pointer to a buffer of length + 1 bytes, otherwise NULL.
+ */
+char *_json_alloc_string(struct json *object, size_t length, unsigned int flag);
+
+/**
+ * Frees the buffer of a key or string of a JSON node.
+ *
+ * Buffers allocated from the pool, as recorded by the given flag, go back to
+ * it, whatever their length; others go back to the allocator.
+ *
+ * @param struct json* object
+ *   The JSON node the buffer belongs to.
+ * @param char* buffer
+ *   The buffer, allocated by _json_alloc_string().
+ * @param unsigned int flag
+ *   JSON_FLAG_KEY_POOLED or JSON_FLAG_VALUE_POOLED.
+ */
+void _json_free_string(struct json *object, char *buffer, unsigned int flag);
+
+/**
+ * Checks whether the key of a JSON node equals the given characters.
+ *
+ * Keys are compared over key_length characters, like the key index does.
+ *
+ * @param const struct json* object
+ *   The JSON node.
+ * @param const char* key
+ *   The key to compare, not necessarily NUL terminated.
+ * @param size_t length
+ *   The number of characters in the key.
+ *
+ * @return int
+ *   Returns 1 when the keys are equal; otherwise, 0.
+ */
+int _json_key_equals(const struct json *object, const char *key, size_t length);
+
+/**
+ * Reads the flags of a JSON node.
+ *
+ * The flags of escaped string views change when they are materialized, so
+ * readers sharing a tree load them atomically.
+ *
+ * @param const struct json* object
+ *   The JSON node.
+ *
+ * @return unsigned int
+ *   The JSON_FLAG_* flags of the node.
+ */
+unsigned int _json_flags(const struct json *object);
+
+/**
+ * Materializes the escaped string view of a JSON string node.
+ *
+ * The view characters are copied into the buffer reserved at decode time the
+ * first time this is called. Concurrent callers wait for the first one.
+ *
+ * @param const struct json* object
+ *   The JSON string node flagged with JSON_FLAG_VALUE_ESCAPED.
+ *
+ * @return const char*
+ *   The NUL terminated materialized string.
+ */
+const char *_json_materialize(const struct json *object);
+
+#endif /* JSON_NODE_H */
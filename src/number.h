@@ -0,0 +1,148 @@
+#ifndef JSON_NUMBER_H
+#define JSON_NUMBER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * The size in bytes of a buffer large enough to hold any formatted number.
+ *
+ * The longest outputs are 17 significant digits with sign, decimal point and
+ * exponent (e.g. "-2.2250738585072014e-308"), plus the NUL terminator.
+ */
+#define JSON_NUMBER_BUFFER_SIZE 32
+
+/**
+ * The kinds of values a JSON number is parsed into.
+ */
+enum json_number_kind {
+  JSON_NUMBER_DOUBLE,
+  JSON_NUMBER_INTEGER,
+  JSON_NUMBER_UNSIGNED
+};
+
+/**
+ * The data struct definition for a parsed JSON number.
+ */
+struct json_number_token {
+
+  /**
+   * The kind of value held by the number.
+   *
+   * @var enum json_number_kind kind.
+   */
+  enum json_number_kind kind;
+
+  /**
+   * The value as a double, for every kind.
+   *
+   * @var double number.
+   */
+  double number;
+
+  /**
+   * The exact value of JSON_NUMBER_INTEGER numbers, or the bits of the exact
+   * value of JSON_NUMBER_UNSIGNED numbers.
+   *
+   * @var int64_t integer.
+   */
+  int64_t integer;
+};
+
+/**
+ * Parses a JSON number.
+ *
+ * Integers without fraction or exponent are kept exact when they fit an
+ * int64_t (or an uint64_t, for positive values). Other numbers are converted
+ * with the Clinger fast path, then the Eisel-Lemire algorithm, and fall back
+ * to strtod() for the rare inputs neither can round correctly.
+ *
+ * @param const char* input
+ *   The number characters, not necessarily NUL terminated.
+ * @param size_t length
+ *   The number of characters available.
+ * @param size_t* consumed
+ *   Receives the number of characters examined: the length of the number on
+ *   success, or the position of the offending character.
+ * @param struct json_number_token* token
+ *   Receives the parsed number.
+ *
+ * @return int
+ *   Returns 1 when a valid number was parsed; otherwise, 0.
+ */
+int _json_parse_number(const char *input, size_t length, size_t *consumed, struct json_number_token *token);
+
+/**
+ * Formats a double with the fewest digits that read back to the same value.
+ *
+ * Doubles holding exact integers take a dedicated integer path; every other
+ * finite value goes through the Grisu2 algorithm. The notation follows the
+ * ECMAScript Number to String rules: plain decimals for exponents in
+ * [-7, 21), scientific notation otherwise. Non-finite values, which JSON
+ * cannot represent, are formatted as "null".
+ *
+ * @param double value
+ *   The value to format.
+ * @param char* buffer
+ *   The destination, at least JSON_NUMBER_BUFFER_SIZE bytes long.
+ *
+ * @return size_t
+ *   The number of characters written, not counting the NUL terminator.
+ */
+size_t _json_format_double(double value, char *buffer);
+
+/**
+ * Formats a signed 64-bit integer.
+ *
+ * @param int64_t value
+ *   The value to format.
+ * @param char* buffer
+ *   The destination, at least JSON_NUMBER_BUFFER_SIZE bytes long.
+ *
+ * @return size_t
+ *   The number of characters written, not counting the NUL terminator.
+ */
+size_t _json_format_int64(int64_t value, char *buffer);
+
+/**
+ * Formats an unsigned 64-bit integer.
+ *
+ * @param uint64_t value
+ *   The value to format.
+ * @param char* buffer
+ *   The destination, at least JSON_NUMBER_BUFFER_SIZE bytes long.
+ *
+ * @return size_t
+ *   The number of characters written, not counting the NUL terminator.
+ */
+size_t _json_format_uint64(uint64_t value, char *buffer);
+
+/**
+ * Converts a double to a signed 64-bit integer, truncating it.
+ *
+ * Values out of range saturate to INT64_MIN or INT64_MAX, and NaN converts
+ * to 0, where a plain cast would be undefined.
+ *
+ * @param double value
+ *   The value to convert.
+ *
+ * @return int64_t
+ *   The converted value.
+ */
+int64_t _json_double_to_int64(double value);
+
+/**
+ * Converts a double to an unsigned 64-bit integer, truncating it.
+ *
+ * Negative values and NaN convert to 0, and values above UINT64_MAX saturate
+ * to UINT64_MAX, where a plain cast would be undefined.
+ *
+ * @param double value
+ *   The value to convert.
+ *
+ * @return uint64_t
+ *   The converted value.
+ */
+uint64_t _json_double_to_uint64(double value);
+
+#endif /* JSON_NUMBER_H */
@@ -1,20 +1,85 @@
 #include <stdlib.h>
-#include <filehelper.h>
+#include "allocator.h"
+#include "document.h"
+#include "mapping.h"
 #include "open.h"
 
 /**
  * {@inheritdoc}
  */
 struct json* json_open(const char* filepath) {
+   // Decode the JSON file straight from a memory mapping.
+   struct json_mapping mapping;
+   if (_json_map_file(filepath, &mapping) == 1) {
+      struct json* json_object = json_decode_n(mapping.data, mapping.length, NULL, NULL);
+      _json_unmap_file(&mapping);
+      return json_object;
+   }
    // Read the JSON file content.
-   char* json_string = file_get_contents(filepath);
+   size_t length = 0;
+   char* json_string = _json_read_file(filepath, NULL, &length);
    if (json_string == NULL) {
       return NULL;
    }
    // Decode the JSON string.
-   struct json* json_object = json_decode(json_string);
+   struct json* json_object = json_decode_n(json_string, length, NULL, NULL);
    // Free the memory.
-   free(json_string);
+   _json_free(NULL, json_string);
    // Return the JSON object.
    return json_object;
 }
+
+/**
+ * {@inheritdoc}
+ */
+struct json* json_document_open(struct json_document* document, const char* filepath) {
+   if (document == NULL || filepath == NULL) {
+      return NULL;
+   }
+   struct json_mapping* mapping = (struct json_mapping*)_arena_alloc(&document->arena, sizeof(struct json_mapping));
+   if (mapping == NULL) {
+      return NULL;
+   }
+   // Decode the JSON file straight from a memory mapping owned by the document.
+   if (_json_map_file(filepath, mapping) == 1) {
+      mapping->next = document->mappings;
+      document->mappings = mapping;
+      return _json_document_decode(document, mapping->data, mapping->length);
+   }
+   // Read the JSON file content into the document arena.
+   size_t length = 0;
+   char* json_string = _json_read_file(filepath, document->arena.allocator, &length);
+   if (json_string == NULL) {
+      return NULL;
+   }
+   char* contents = _arena_strndup(&document->arena, json_string, length);
+   _json_free(document->arena.allocator, json_string);
+   if (contents == NULL) {
+      return NULL;
+   }
+   return _json_document_decode(document, contents, length);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int json_open_lines(const char* filepath, const struct json_lines_options* options, int (*on_record)(void* context, size_t line, struct json* record), void* context) {
+   // Decode the records straight from a memory mapping.
+   struct json_mapping mapping;
+   if (_json_map_file(filepath, &mapping) == 1) {
+      int status = json_decode_lines(mapping.data, mapping.length, options, on_record, context);
+      _json_unmap_file(&mapping);
+      return status;
+   }
+   // Read the JSON file content.
+   const struct json_allocator* allocator = options != NULL ? options->decode.allocator : NULL;
+   size_t length = 0;
+   char* json_string = _json_read_file(filepath, allocator, &length);
+   if (json_string == NULL) {
+      return 0;
+   }
+   int status = json_decode_lines(json_string, length, options, on_record, context);
+   // Free the memory.
+   _json_free(allocator, json_string);
+   return status;
+}
@@ -0,0 +1,288 @@
+#include <stdlib.h>
+#include <string.h>
+#include "allocator.h"
+#include "parser.h"
+
+/**
+ * Allocates and initializes a parser.
+ *
+ * @param const struct json_decode_options* options
+ *   The decoding options, or NULL to use the defaults.
+ *
+ * @return struct json_parser*
+ *   The pointer to the parser, otherwise NULL.
+ */
+static struct json_parser *_parser_create(const struct json_decode_options *options) {
+  const struct json_allocator *allocator = options != NULL ? options->allocator : NULL;
+  struct json_parser *parser = (struct json_parser *)_json_alloc(allocator, sizeof(struct json_parser));
+  if (parser == NULL) {
+    return NULL;
+  }
+  _decoder_init(&parser->decoder, NULL, 0, NULL);
+  parser->decoder.allocator = allocator;
+  if (options != NULL && options->max_depth > 0) {
+    parser->decoder.max_depth = options->max_depth;
+  }
+  // Values cannot reference chunks that are gone once consumed.
+  if (options != NULL) {
+    parser->decoder.flags = options->flags & ~JSON_DECODE_ZERO_COPY;
+  }
+  parser->decoder.partial = 1;
+  parser->tree.decoder = &parser->decoder;
+  parser->tree.root = NULL;
+  parser->on_json = NULL;
+  parser->context = NULL;
+  parser->pending = NULL;
+  parser->pending_length = 0;
+  parser->pending_capacity = 0;
+  parser->failed = 0;
+  return parser;
+}
+
+/**
+ * Stores the given characters at the end of the pending buffer.
+ *
+ * @param struct json_parser* parser
+ *   The parser instance.
+ * @param const char* characters
+ *   The characters to store.
+ * @param size_t length
+ *   The number of characters to store.
+ *
+ * @return int
+ *   Returns 1 when the characters were stored; otherwise, 0.
+ */
+static int _parser_append(struct json_parser *parser, const char *characters, size_t length) {
+  if (length == 0) {
+    return 1;
+  }
+  if (parser->pending_capacity - parser->pending_length < length) {
+    size_t capacity = parser->pending_capacity == 0 ? 256 : parser->pending_capacity;
+    while (capacity - parser->pending_length < length) {
+      capacity *= 2;
+    }
+    char *pending = (char *)_json_realloc(parser->decoder.allocator, parser->pending, capacity);
+    if (pending == NULL) {
+      return 0;
+    }
+    parser->pending = pending;
+    parser->pending_capacity = capacity;
+  }
+  memcpy(parser->pending + parser->pending_length, characters, length);
+  parser->pending_length += length;
+  return 1;
+}
+
+/**
+ * Consumes the complete tokens of the given input.
+ *
+ * Every complete root value is handed over to the on_json callback, and the
+ * token cut off by the end of the input is kept in the pending buffer.
+ *
+ * @param struct json_parser* parser
+ *   The parser instance.
+ * @param const char* input
+ *   The characters to consume, which may be the pending buffer itself.
+ * @param size_t length
+ *   The number of characters to consume.
+ *
+ * @return int
+ *   Returns 1 when the input was consumed; otherwise, 0.
+ */
+static int _parser_consume(struct json_parser *parser, const char *input, size_t length) {
+  struct json_decoder *decoder = &parser->decoder;
+  int status = -1;
+  _decoder_set_input(decoder, input, length);
+  while (decoder->position < decoder->length) {
+    status = _decoder_run(decoder);
+    if (status != 1) {
+      break;
+    }
+    // Hand the complete JSON object over.
+    if (parser->on_json != NULL) {
+      struct json *root = parser->tree.root;
+      parser->tree.root = NULL;
+      if (parser->on_json(parser->context, root) == 0) {
+        status = 0;
+        break;
+      }
+    }
+    _decoder_skip_value(decoder);
+    status = -1;
+  }
+  if (status == 0) {
+    parser->failed = 1;
+    return 0;
+  }
+  // Keep the characters of the cut off token.
+  const size_t remaining = decoder->position < length ? length - decoder->position : 0;
+  if (input == parser->pending) {
+    // The scan of a token still cut off resumes where it stopped.
+    if (decoder->position > 0) {
+      memmove(parser->pending, parser->pending + decoder->position, remaining);
+    }
+    parser->pending_length = remaining;
+    return 1;
+  }
+  parser->pending_length = 0;
+  if (_parser_append(parser, input + decoder->position, remaining) == 0) {
+    parser->failed = 1;
+    return 0;
+  }
+  return 1;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct json_parser *json_parser_create(const struct json_decode_options *options, const struct json_sax_handler *handler, void *context) {
+  if (handler == NULL) {
+    return NULL;
+  }
+  struct json_parser *parser = _parser_create(options);
+  if (parser == NULL) {
+    return NULL;
+  }
+  parser->decoder.handler = handler;
+  parser->decoder.context = context;
+  return parser;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct json_parser *json_parser_create_tree(const struct json_decode_options *options, int (*on_json)(void *context, struct json *object), void *context) {
+  if (on_json == NULL) {
+    return NULL;
+  }
+  struct json_parser *parser = _parser_create(options);
+  if (parser == NULL) {
+    return NULL;
+  }
+  _decoder_build_tree(&parser->decoder, &parser->tree);
+  parser->on_json = on_json;
+  parser->context = context;
+  return parser;
+}
+
+/**
+ * Returns the number of characters of a chunk that complete the pending token.
+ *
+ * A string ends with its closing double quote, and other tokens (numbers and
+ * literals) with the first character that cannot continue them, which is
+ * included so that the token does not end the input.
+ *
+ * @param const struct json_parser* parser
+ *   The parser instance, with a pending token.
+ * @param const char* buffer
+ *   The chunk characters.
+ * @param size_t length
+ *   The number of characters in the chunk.
+ *
+ * @return size_t
+ *   The number of characters up to the end of the token, or the length of the
+ *   chunk when it does not complete the token.
+ */
+static size_t _parser_token_end(const struct json_parser *parser, const char *buffer, size_t length) {
+  if (parser->pending[0] != '\"') {
+    for (size_t i = 0; i < length; i++) {
+      const char token = buffer[i];
+      const int digit = token >= '0' && token <= '9';
+      const int letter = (token >= 'a' && token <= 'z') || (token >= 'A' && token <= 'Z');
+      if (!digit && !letter && token != '+' && token != '-' && token != '.') {
+        return i + 1;
+      }
+    }
+    return length;
+  }
+  // Count the backslashes ending the pending characters, after the opening quote.
+  size_t pending_backslashes = 0;
+  while (pending_backslashes + 1 < parser->pending_length && parser->pending[parser->pending_length - pending_backslashes - 1] == '\\') {
+    pending_backslashes++;
+  }
+  // The double quote is escaped when preceded by an odd number of backslashes.
+  const char *quote = (const char *)memchr(buffer, '\"', length);
+  while (quote != NULL) {
+    const size_t end = (size_t)(quote - buffer);
+    size_t backslashes = 0;
+    while (backslashes < end && buffer[end - backslashes - 1] == '\\') {
+      backslashes++;
+    }
+    if (backslashes == end) {
+      backslashes += pending_backslashes;
+    }
+    if (backslashes % 2 == 0) {
+      return end + 1;
+    }
+    quote = (const char *)memchr(quote + 1, '\"', length - end - 1);
+  }
+  return length;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int json_parser_feed(struct json_parser *parser, const char *buffer, size_t length) {
+  if (parser == NULL || parser->failed || (buffer == NULL && length > 0)) {
+    return 0;
+  }
+  // Parse the chunk in place unless it completes a cut off token.
+  if (parser->pending_length == 0) {
+    return _parser_consume(parser, buffer, length);
+  }
+  // Only copy the characters completing the token, then parse the rest in place.
+  const size_t end = _parser_token_end(parser, buffer, length);
+  if (_parser_append(parser, buffer, end) == 0) {
+    parser->failed = 1;
+    return 0;
+  }
+  if (_parser_consume(parser, parser->pending, parser->pending_length) == 0) {
+    return 0;
+  }
+  if (end == length) {
+    return 1;
+  }
+  // A token left pending by invalid input keeps collecting the chunk.
+  if (parser->pending_length > 0) {
+    if (_parser_append(parser, buffer + end, length - end) == 0) {
+      parser->failed = 1;
+      return 0;
+    }
+    return _parser_consume(parser, parser->pending, parser->pending_length);
+  }
+  return _parser_consume(parser, buffer + end, length - end);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int json_parser_finish(struct json_parser *parser) {
+  if (parser == NULL || parser->failed) {
+    return 0;
+  }
+  // Complete the pending token, which can no longer continue.
+  struct json_decoder *decoder = &parser->decoder;
+  decoder->partial = 0;
+  int status = parser->pending_length == 0 || _parser_consume(parser, parser->pending, parser->pending_length) == 1;
+  decoder->partial = 1;
+  // The input must not end inside a value.
+  if (status == 0 || parser->pending_length > 0 || decoder->depth > 0 || decoder->state != JSON_DECODER_VALUE) {
+    parser->failed = 1;
+    return 0;
+  }
+  return 1;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void json_parser_free(struct json_parser *parser) {
+  if (parser == NULL) {
+    return;
+  }
+  const struct json_allocator *allocator = parser->decoder.allocator;
+  _decoder_destroy_tree(&parser->tree);
+  _decoder_release(&parser->decoder);
+  _json_free(allocator, parser->pending);
+  _json_free(allocator, parser);
+}
@@ -0,0 +1,74 @@
+#ifndef JSON_PARSER_INTERNAL_H
+#define JSON_PARSER_INTERNAL_H
+
+#include "decoder.h"
+#include "../include/json.h"
+
+/**
+ * The data struct definition for an incremental JSON parser.
+ *
+ * The parser keeps the decoder state between chunks. Only a token cut off by
+ * the end of a chunk is copied, into the pending buffer, to be completed by
+ * the first characters of the next chunk; the rest of that chunk is parsed in
+ * place.
+ */
+struct json_parser {
+
+  /**
+   * The decoder, whose state survives between chunks.
+   *
+   * @var struct json_decoder decoder.
+   */
+  struct json_decoder decoder;
+
+  /**
+   * The tree building state, when the parser builds JSON objects.
+   *
+   * @var struct json_decoder_tree tree.
+   */
+  struct json_decoder_tree tree;
+
+  /**
+   * The callback receiving every decoded JSON object, or NULL for events.
+   *
+   * @var int (*on_json)(void *context, struct json *object).
+   */
+  int (*on_json)(void *context, struct json *object);
+
+  /**
+   * The context passed to the on_json callback.
+   *
+   * @var void* context.
+   */
+  void *context;
+
+  /**
+   * The characters of the token cut off by the end of the latest chunk.
+   *
+   * @var char* pending.
+   */
+  char *pending;
+
+  /**
+   * The number of pending characters.
+   *
+   * @var size_t pending_length.
+   */
+  size_t pending_length;
+
+  /**
+   * The number of characters the pending buffer can hold before growing.
+   *
+   * @var size_t pending_capacity.
+   */
+  size_t pending_capacity;
+
+  /**
+   * Whether the parser hit a syntax error or was stopped by a callback.
+   *
+   * @var int failed.
+   */
+  int failed;
+};
+
+#endif /* JSON_PARSER_INTERNAL_H */
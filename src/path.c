@@ -0,0 +1,125 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "allocator.h"
+#include "index.h"
+#include "node.h"
+#include "path.h"
+
+/**
+ * Parses an array index made of decimal digits only.
+ *
+ * @param const char* key
+ *   The key characters.
+ * @param size_t length
+ *   The number of characters in the key.
+ * @param size_t* index
+ *   Receives the array index.
+ *
+ * @return int
+ *   Returns 1 when the key is an array index; otherwise, 0.
+ */
+static int _path_parse_index(const char *key, size_t length, size_t *index) {
+  size_t value = 0;
+  for (size_t i = 0; i < length; i++) {
+    const unsigned digit = (unsigned char)key[i] - '0';
+    if (digit > 9 || value > (SIZE_MAX - digit) / 10) {
+      return 0;
+    }
+    value = value * 10 + digit;
+  }
+  *index = value;
+  return length > 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct json_path *json_path_compile(const char *path, const char delimiter) {
+  if (path == NULL) {
+    return NULL;
+  }
+  // Count the non-empty segments, which are skipped like strtok() does.
+  const size_t length = strlen(path);
+  size_t count = 0;
+  for (size_t i = 0; i < length; i++) {
+    if (path[i] != delimiter && (i == 0 || path[i - 1] == delimiter)) {
+      count++;
+    }
+  }
+  if (count == 0) {
+    return NULL;
+  }
+  // Store the segments and a NUL terminated copy of their keys in one allocation.
+  const size_t size = sizeof(struct json_path) + count * sizeof(struct json_path_segment);
+  struct json_path *compiled = (struct json_path *)_json_alloc(NULL, size + length + 1);
+  if (compiled == NULL) {
+    return NULL;
+  }
+  char *keys = (char *)compiled + size;
+  memcpy(keys, path, length + 1);
+  compiled->count = 0;
+  for (size_t i = 0; i < length;) {
+    if (keys[i] == delimiter) {
+      keys[i++] = '\0';
+      continue;
+    }
+    struct json_path_segment *segment = &compiled->segments[compiled->count++];
+    const char *end = memchr(keys + i, delimiter, length - i);
+    segment->key = keys + i;
+    segment->length = end != NULL ? (size_t)(end - (keys + i)) : length - i;
+    segment->hash = _json_index_hash(segment->key, segment->length);
+    segment->is_index = _path_parse_index(segment->key, segment->length, &segment->index);
+    i += segment->length;
+  }
+  return compiled;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct json *json_path_eval(struct json *object, const struct json_path *path) {
+  if (object == NULL || path == NULL) {
+    return NULL;
+  }
+  // Set the node, and the node whose value is the current chain of members.
+  struct json *node = object;
+  struct json *owner = NULL;
+  for (size_t i = 0; i < path->count && node != NULL; i++) {
+    const struct json_path_segment *segment = &path->segments[i];
+    // Array elements are selected by position.
+    if (node->type == JSON_array) {
+      if (segment->is_index == 0) {
+        return NULL;
+      }
+      node = json_array_get(node, segment->index);
+      owner = NULL;
+      continue;
+    }
+    // Step into the members of keyless object containers.
+    if (node->key == NULL && node->type == JSON_object) {
+      owner = node;
+      node = (struct json *)node->value;
+    }
+    // Object members are selected by key, through the key index of large objects.
+    if (owner != NULL && owner->type == JSON_object && owner->value == node) {
+      node = _json_index_find_hashed(owner, segment->key, segment->length, segment->hash);
+    } else {
+      while (node != NULL && _json_key_equals(node, segment->key, segment->length) == 0) {
+        node = node->next;
+      }
+    }
+    owner = node;
+    if (node != NULL) {
+      node = (struct json *)node->value;
+    }
+  }
+  return node;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void json_path_free(struct json_path *path) {
+  _json_free(NULL, path);
+}
@@ -0,0 +1,70 @@
+#ifndef JSON_PATH_INTERNAL_H
+#define JSON_PATH_INTERNAL_H
+
+#include <stddef.h>
+#include "../include/json.h"
+
+/**
+ * The data struct definition for a segment of a compiled JSON path.
+ */
+struct json_path_segment {
+
+  /**
+   * The NUL terminated key of the segment.
+   *
+   * @var const char* key.
+   */
+  const char *key;
+
+  /**
+   * The number of characters in the key.
+   *
+   * @var size_t length.
+   */
+  size_t length;
+
+  /**
+   * The hash of the key, as computed by _json_index_hash().
+   *
+   * @var size_t hash.
+   */
+  size_t hash;
+
+  /**
+   * Whether the key is an array index.
+   *
+   * @var int is_index.
+   */
+  int is_index;
+
+  /**
+   * The array index, when the key is made of decimal digits only.
+   *
+   * @var size_t index.
+   */
+  size_t index;
+};
+
+/**
+ * The data struct definition for a compiled JSON path.
+ *
+ * The segments and their keys are stored in the same allocation.
+ */
+struct json_path {
+
+  /**
+   * The number of segments.
+   *
+   * @var size_t count.
+   */
+  size_t count;
+
+  /**
+   * The segments.
+   *
+   * @var struct json_path_segment segments[].
+   */
+  struct json_path_segment segments[];
+};
+
+#endif /* JSON_PATH_INTERNAL_H */
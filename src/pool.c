@@ -0,0 +1,378 @@
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "allocator.h"
+#include "pool.h"
+
+/**
+ * The number of block size classes.
+ */
+#define JSON_POOL_CLASSES 3
+
+/**
+ * The size in bytes of the pages of a slab.
+ *
+ * Pages are aligned to their size, so that a block finds its page header by
+ * masking its address.
+ */
+#define JSON_POOL_PAGE_SIZE 4096
+
+/**
+ * The size in bytes reserved for the header of every page.
+ *
+ * It keeps the blocks cache line aligned, and holds the slab itself in the
+ * first page.
+ */
+#define JSON_POOL_PAGE_HEADER 64
+
+/**
+ * The data struct definition for a slab.
+ */
+struct json_pool_slab {
+
+  /**
+   * The allocation holding the slab.
+   *
+   * @var void* memory.
+   */
+  void *memory;
+
+  /**
+   * The number of blocks not released yet, counting those not carved yet.
+   *
+   * @var size_t refs.
+   */
+  size_t refs;
+};
+
+/**
+ * The data struct definition for the header of a slab page.
+ */
+struct json_pool_page {
+
+  /**
+   * The slab the page belongs to.
+   *
+   * @var struct json_pool_slab* slab.
+   */
+  struct json_pool_slab *slab;
+
+  /**
+   * The size of the blocks carved from the page.
+   *
+   * @var size_t size.
+   */
+  size_t size;
+};
+
+/**
+ * The data struct definition for a free block.
+ */
+struct json_pool_block {
+
+  /**
+   * The next free block of the same size class.
+   *
+   * @var struct json_pool_block* next.
+   */
+  struct json_pool_block *next;
+};
+
+/**
+ * The data struct definition for the slab a thread carves blocks from.
+ */
+struct json_pool_carver {
+
+  /**
+   * The slab being carved.
+   *
+   * @var struct json_pool_slab* slab.
+   */
+  struct json_pool_slab *slab;
+
+  /**
+   * The address of the next block.
+   *
+   * @var uintptr_t next.
+   */
+  uintptr_t next;
+
+  /**
+   * The end address of the page being carved.
+   *
+   * @var uintptr_t page_end.
+   */
+  uintptr_t page_end;
+
+  /**
+   * The number of blocks left to carve from the slab.
+   *
+   * @var size_t remaining.
+   */
+  size_t remaining;
+};
+
+/**
+ * The data struct definition for the blocks of a thread.
+ */
+struct json_pool {
+
+  /**
+   * The free lists, by size class.
+   *
+   * @var struct json_pool_block* blocks[].
+   */
+  struct json_pool_block *blocks[JSON_POOL_CLASSES];
+
+  /**
+   * The number of blocks of every free list.
+   *
+   * @var size_t counts[].
+   */
+  size_t counts[JSON_POOL_CLASSES];
+
+  /**
+   * The slabs being carved, by size class.
+   *
+   * @var struct json_pool_carver carvers[].
+   */
+  struct json_pool_carver carvers[JSON_POOL_CLASSES];
+
+  /**
+   * Whether the pool is registered to be trimmed when the thread exits.
+   *
+   * @var int registered.
+   */
+  int registered;
+};
+
+_Static_assert(sizeof(struct json_pool_page) + sizeof(struct json_pool_slab) <= JSON_POOL_PAGE_HEADER, "The slab must fit in the header of its first page.");
+_Static_assert(JSON_POOL_SLAB_SIZE >= 2 * JSON_POOL_PAGE_SIZE, "A slab must hold at least one aligned page.");
+
+/**
+ * The blocks of the calling thread.
+ */
+static _Thread_local struct json_pool _pool_local;
+
+/**
+ * The key whose destructor trims the pool of exiting threads.
+ */
+static pthread_key_t _pool_key;
+
+/**
+ * Whether the key could be created.
+ */
+static int _pool_key_created = 0;
+
+/**
+ * Guards the creation of the key.
+ */
+static pthread_once_t _pool_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Returns the size class of a block size.
+ *
+ * @param size_t size
+ *   The number of bytes, at most JSON_POOL_MAX_SIZE.
+ *
+ * @return size_t
+ *   The index of the smallest class fitting the size.
+ */
+static size_t _pool_class(size_t size) {
+  return size <= 32 ? 0 : (size <= 64 ? 1 : 2);
+}
+
+/**
+ * Returns the header of the page holding a block.
+ *
+ * @param const void* block
+ *   The block, carved from a slab.
+ *
+ * @return struct json_pool_page*
+ *   The page header.
+ */
+static struct json_pool_page *_pool_page(const void *block) {
+  return (struct json_pool_page *)((uintptr_t)block & ~(uintptr_t)(JSON_POOL_PAGE_SIZE - 1));
+}
+
+/**
+ * Releases blocks of a slab, returning the slab to the allocator with its last block.
+ *
+ * @param struct json_pool_slab* slab
+ *   The slab instance.
+ * @param size_t count
+ *   The number of blocks released.
+ *
+ * @return size_t
+ *   The number of bytes returned to the allocator.
+ */
+static size_t _pool_slab_release(struct json_pool_slab *slab, size_t count) {
+  // Blocks may be released by any thread, so the last one frees the slab.
+  if (__atomic_sub_fetch(&slab->refs, count, __ATOMIC_ACQ_REL) != 0) {
+    return 0;
+  }
+  _json_free(NULL, slab->memory);
+  return JSON_POOL_SLAB_SIZE;
+}
+
+/**
+ * Releases the free blocks and the blocks left to carve of a pool.
+ *
+ * @param struct json_pool* pool
+ *   The pool instance.
+ *
+ * @return size_t
+ *   The number of bytes returned to the allocator.
+ */
+static size_t _pool_release(struct json_pool *pool) {
+  size_t released = 0;
+  for (size_t i = 0; i < JSON_POOL_CLASSES; i++) {
+    while (pool->blocks[i] != NULL) {
+      struct json_pool_block *block = pool->blocks[i];
+      pool->blocks[i] = block->next;
+      released += _pool_slab_release(_pool_page(block)->slab, 1);
+    }
+    pool->counts[i] = 0;
+    struct json_pool_carver *carver = &pool->carvers[i];
+    if (carver->remaining > 0) {
+      released += _pool_slab_release(carver->slab, carver->remaining);
+      carver->remaining = 0;
+    }
+  }
+  return released;
+}
+
+/**
+ * Trims the pool of an exiting thread.
+ *
+ * @param void* pool
+ *   The pool of the thread.
+ */
+static void _pool_destructor(void *pool) {
+  // Blocks allocated or freed by later destructors register the pool again.
+  ((struct json_pool *)pool)->registered = 0;
+  _pool_release((struct json_pool *)pool);
+}
+
+/**
+ * Creates the key trimming the pools of exiting threads.
+ */
+static void _pool_create_key(void) {
+  _pool_key_created = pthread_key_create(&_pool_key, _pool_destructor) == 0;
+}
+
+/**
+ * Registers a pool to be trimmed when the calling thread exits.
+ *
+ * @param struct json_pool* pool
+ *   The pool of the calling thread.
+ *
+ * @return int
+ *   Returns 1 if the pool is registered; otherwise, 0.
+ */
+static int _pool_register(struct json_pool *pool) {
+  if (pool->registered == 0) {
+    pthread_once(&_pool_once, _pool_create_key);
+    if (_pool_key_created == 0 || pthread_setspecific(_pool_key, pool) != 0) {
+      return 0;
+    }
+    pool->registered = 1;
+  }
+  return 1;
+}
+
+/**
+ * Carves a block from the slab of a size class, allocating a new slab once it is full.
+ *
+ * @param struct json_pool* pool
+ *   The pool of the calling thread.
+ * @param size_t index
+ *   The size class.
+ *
+ * @return void*
+ *   The pointer to the block, otherwise NULL.
+ */
+static void *_pool_carve(struct json_pool *pool, size_t index) {
+  const size_t size = (size_t)32 << index;
+  struct json_pool_carver *carver = &pool->carvers[index];
+  if (carver->remaining == 0) {
+    // The thread holds the blocks left to carve, released when it exits.
+    if (_pool_register(pool) == 0) {
+      return NULL;
+    }
+    void *memory = _json_alloc(NULL, JSON_POOL_SLAB_SIZE);
+    if (memory == NULL) {
+      return NULL;
+    }
+    // Split the aligned pages of the allocation, the first one holding the slab.
+    const uintptr_t mask = ~(uintptr_t)(JSON_POOL_PAGE_SIZE - 1);
+    const uintptr_t first = ((uintptr_t)memory + JSON_POOL_PAGE_SIZE - 1) & mask;
+    const uintptr_t end = ((uintptr_t)memory + JSON_POOL_SLAB_SIZE) & mask;
+    struct json_pool_slab *slab = (struct json_pool_slab *)(first + sizeof(struct json_pool_page));
+    slab->memory = memory;
+    slab->refs = (end - first) / JSON_POOL_PAGE_SIZE * ((JSON_POOL_PAGE_SIZE - JSON_POOL_PAGE_HEADER) / size);
+    for (uintptr_t page = first; page < end; page += JSON_POOL_PAGE_SIZE) {
+      ((struct json_pool_page *)page)->slab = slab;
+      ((struct json_pool_page *)page)->size = size;
+    }
+    carver->slab = slab;
+    carver->next = first + JSON_POOL_PAGE_HEADER;
+    carver->page_end = first + JSON_POOL_PAGE_SIZE;
+    carver->remaining = slab->refs;
+  } else if (carver->next + size > carver->page_end) {
+    // Move on to the next page.
+    carver->next = carver->page_end + JSON_POOL_PAGE_HEADER;
+    carver->page_end += JSON_POOL_PAGE_SIZE;
+  }
+  void *block = (void *)carver->next;
+  carver->next += size;
+  carver->remaining--;
+  return block;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void *_json_pool_alloc(size_t size) {
+  if (size > JSON_POOL_MAX_SIZE) {
+    return _json_alloc(NULL, size);
+  }
+  const size_t index = _pool_class(size);
+  struct json_pool *pool = &_pool_local;
+  struct json_pool_block *block = pool->blocks[index];
+  if (block == NULL) {
+    return _pool_carve(pool, index);
+  }
+  pool->blocks[index] = block->next;
+  pool->counts[index]--;
+  return block;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void _json_pool_free(void *pointer) {
+  if (pointer == NULL) {
+    return;
+  }
+  struct json_pool_page *page = _pool_page(pointer);
+  struct json_pool *pool = &_pool_local;
+  const size_t index = _pool_class(page->size);
+  // Keep the block for reuse by the calling thread, registering the pool the
+  // first time so that it is trimmed when the thread exits.
+  if (pool->counts[index] >= JSON_POOL_MAX_BLOCKS || _pool_register(pool) == 0) {
+    _pool_slab_release(page->slab, 1);
+    return;
+  }
+  struct json_pool_block *block = (struct json_pool_block *)pointer;
+  block->next = pool->blocks[index];
+  pool->blocks[index] = block;
+  pool->counts[index]++;
+}
+
+/**
+ * {@inheritdoc}
+ */
+size_t json_pool_trim(void) {
+  return _pool_release(&_pool_local);
+}
@@ -0,0 +1,62 @@
+#ifndef JSON_POOL_H
+#define JSON_POOL_H
+
+#include <stddef.h>
+#include "../include/json.h"
+
+/**
+ * The size in bytes of the largest block served from the pool.
+ *
+ * Blocks are rounded up to 32, 64 or 128 bytes; nodes use the 64-byte class,
+ * keys and out-of-line strings the class that fits them.
+ */
+#define JSON_POOL_MAX_SIZE 128
+
+/**
+ * The maximum number of free blocks a thread keeps per size class.
+ *
+ * Blocks freed beyond it go back to the slab they were carved from.
+ */
+#ifndef JSON_POOL_MAX_BLOCKS
+#define JSON_POOL_MAX_BLOCKS 4096
+#endif
+
+/**
+ * The size in bytes of the slabs blocks are carved from.
+ *
+ * A slab is split into pages of one size class and goes back to the
+ * allocator once every block carved from it has been released.
+ */
+#ifndef JSON_POOL_SLAB_SIZE
+#define JSON_POOL_SLAB_SIZE 65536
+#endif
+
+/**
+ * Allocates a block from the pool of the calling thread.
+ *
+ * The block is recycled from the thread free list of the size class fitting
+ * the requested size, otherwise carved from the slab the thread fills. Sizes
+ * above JSON_POOL_MAX_SIZE are passed to the allocator instead, and must be
+ * freed with _json_free().
+ *
+ * @param size_t size
+ *   The number of bytes to allocate.
+ *
+ * @return void*
+ *   The pointer to the allocated memory, otherwise NULL.
+ */
+void *_json_pool_alloc(size_t size);
+
+/**
+ * Returns a block to the pool of the calling thread.
+ *
+ * Blocks may be returned by any thread, not only the one that allocated them.
+ * Their size class is read from the slab page holding them.
+ *
+ * @param void* pointer
+ *   The block, allocated by _json_pool_alloc() with at most JSON_POOL_MAX_SIZE
+ *   bytes. May be NULL.
+ */
+void _json_pool_free(void *pointer);
+
+#endif /* JSON_POOL_H */
@@ -1,45 +1,49 @@
 #include <stdio.h>
-#include <stdlib.h>
-#include <strutils.h>
 #include "print.h"
 
+/**
+ * Writes encoded characters to the standard output.
+ *
+ * @param void* context
+ *   Unused.
+ * @param const char* data
+ *   The characters to write.
+ * @param size_t length
+ *   The number of characters to write.
+ *
+ * @return int
+ *   Returns 1 when the characters were written; otherwise, 0.
+ */
+static int _print_write(void *context, const char *data, size_t length) {
+   (void)context;
+   return fwrite(data, 1, length, stdout) == length;
+}
+
 /**
  * {@inheritdoc}
  */
 void json_string_print(const char* json_string) {
-   // Init the String Tokenizer instance.
-   struct StringTokenizer *tokenizer = st_create((char*)json_string);
-   if (tokenizer == NULL) {
+   // Decode the JSON string to print it without spaces.
+   struct json *object = json_decode(json_string);
+   if (object == NULL) {
+      printf("%s", json_string);
       return;
    }
-   // Print the JSON file without spaces.
-   char token = st_current_token(tokenizer);
-   while (token != '\0') {
-      // Print the current token/character.
-      printf("%c", token);
-      // Find the next valid token/character.
-      st_next_token(tokenizer);
-      // Get the next token/character.
-      token = st_current_token(tokenizer);
-   }
-   // Free the tokenizer memory.
-   st_destroy(tokenizer);
+   struct json_sink sink = json_sink_callback(_print_write, NULL);
+   json_encode_to(object, &sink);
+   json_destroy(object);
 }
 
 /**
  * {@inheritdoc}
  */
 void json_object_print(struct json* object) {
-   // Encode the JSON object.
-   char* json_string = json_encode(object);
-   if (json_string == NULL) {
-      printf("Failed to encode JSON.\n");
-      return NULL;
-   }
-   // Print the JSON string.
+   // Stream the encoded JSON object to the standard output in batches.
+   struct json_sink sink = json_sink_callback(_print_write, NULL);
    printf("Encode JSON: ");
-   json_string_print(json_string);
+   if (json_encode_to(object, &sink) == 0) {
+      printf("\nFailed to encode JSON.\n");
+      return;
+   }
    printf("\n");
-   // Free JSOn string memory.
-   free(json_string);
 }
@@ -4,7 +4,9 @@
 #include "../include/json.h"
 
 /**
- * Prints a JSON string.
+ * Prints a JSON string without spaces.
+ *
+ * Strings that are not valid JSON are printed as they are.
  *
  * @param const char* json_string
  *   The json string to print.
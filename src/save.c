@@ -1,16 +1,21 @@
-#include <stdlib.h>
-#include <filehelper.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include "save.h"
 
 /**
  * {@inheritdoc}
  */
 int json_save(struct json* json_object, const char* filepath) {
-   // Encode the JSON object.
-   char* json_string = json_encode(json_object);
-   if (json_string == NULL) {
-      return NULL;
+   // Open the file for writing.
+   int fd = open(filepath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+   if (fd < 0) {
+      return 0;
    }
-   // Save the JSON string into the given file path.
-   return file_put_contents(filepath, json_string);
+   // Stream the encoded JSON object into the file.
+   struct json_sink sink = json_sink_fd(fd);
+   int status = json_encode_to(json_object, &sink);
+   if (close(fd) != 0) {
+      status = 0;
+   }
+   return status;
 }
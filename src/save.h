@@ -6,6 +6,9 @@
 /**
  * Saves the given JSON object to the given file path.
  *
+ * The file is truncated and the encoding streamed into it, so a failed save
+ * may leave it partially written.
+ *
  * @param struct json* json_object
  *   The JSON object to save.
  * @param const char* filepath
@@ -0,0 +1,40 @@
+#include "decoder.h"
+#include "escape.h"
+
+/**
+ * {@inheritdoc}
+ */
+int json_sax_parse(const char *buffer, size_t length, size_t *offset, const struct json_decode_options *options, const struct json_sax_handler *handler, void *context) {
+  if (buffer == NULL || handler == NULL) {
+    return 0;
+  }
+  // Init the decoder instance.
+  struct json_decoder decoder;
+  _decoder_init(&decoder, buffer, length, NULL);
+  if (options != NULL && options->max_depth > 0) {
+    decoder.max_depth = options->max_depth;
+  }
+  if (options != NULL) {
+    decoder.flags = options->flags;
+    decoder.allocator = options->allocator;
+  }
+  decoder.handler = handler;
+  decoder.context = context;
+  // Report the JSON values to the handler.
+  int status = _decoder_parse(&decoder);
+  // Report where parsing stopped.
+  if (offset != NULL) {
+    *offset = status == 1 ? decoder.position + 1 : decoder.position;
+  }
+  return status;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int json_sax_unescape(char *destination, const char *characters, size_t length, int flags, size_t *written_length) {
+  if (destination == NULL || characters == NULL || written_length == NULL) {
+    return 0;
+  }
+  return _json_unescape_string(destination, characters, length, (flags & JSON_DECODE_STRICT) != 0, written_length);
+}
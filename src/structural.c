@@ -0,0 +1,317 @@
+#include <stdlib.h>
+#include <string.h>
+#include "allocator.h"
+#include "structural.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define JSON_STRUCTURAL_X86 1
+#endif
+
+/**
+ * Classifies a block of 64 bytes one character at a time.
+ *
+ * This is the portable fallback used when no SIMD kernel is supported.
+ *
+ * @param const char* block
+ *   The 64 bytes to classify.
+ * @param struct json_structural_block* classes
+ *   Receives the character classes of the block.
+ */
+static void _structural_classify_scalar(const char *block, struct json_structural_block *classes) {
+  classes->quotes = 0;
+  classes->backslashes = 0;
+  classes->whitespaces = 0;
+  classes->operators = 0;
+  for (int i = 0; i < JSON_STRUCTURAL_BLOCK_SIZE; ++i) {
+    const uint64_t bit = (uint64_t)1 << i;
+    switch (block[i]) {
+      case '\"':
+        classes->quotes |= bit;
+        break;
+      case '\\':
+        classes->backslashes |= bit;
+        break;
+      case ' ':
+      case '\t':
+      case '\n':
+      case '\r':
+        classes->whitespaces |= bit;
+        break;
+      case '{':
+      case '}':
+      case '[':
+      case ']':
+      case ':':
+      case ',':
+        classes->operators |= bit;
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+#ifdef JSON_STRUCTURAL_X86
+
+/**
+ * Returns the mask of the characters of a 64 bytes block equal to any character of a set.
+ *
+ * Uses the SSE4.2 explicit length string comparison, 16 bytes at a time.
+ *
+ * @param const char* block
+ *   The 64 bytes to classify.
+ * @param __m128i set
+ *   The characters of the set.
+ * @param int set_length
+ *   The number of characters in the set.
+ *
+ * @return uint64_t
+ *   The mask of the matching characters.
+ */
+__attribute__((target("sse4.2")))
+static uint64_t _structural_match_sse42(const char *block, __m128i set, int set_length) {
+  uint64_t mask = 0;
+  for (int i = 0; i < 4; ++i) {
+    const __m128i chunk = _mm_loadu_si128((const __m128i *)(block + 16 * i));
+    const __m128i match = _mm_cmpestrm(set, set_length, chunk, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK);
+    mask |= (uint64_t)(uint16_t)_mm_cvtsi128_si32(match) << (16 * i);
+  }
+  return mask;
+}
+
+/**
+ * Classifies a block of 64 bytes with SSE4.2 instructions.
+ *
+ * @param const char* block
+ *   The 64 bytes to classify.
+ * @param struct json_structural_block* classes
+ *   Receives the character classes of the block.
+ */
+__attribute__((target("sse4.2")))
+static void _structural_classify_sse42(const char *block, struct json_structural_block *classes) {
+  const __m128i quote = _mm_setr_epi8('\"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m128i backslash = _mm_setr_epi8('\\', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m128i whitespaces = _mm_setr_epi8(' ', '\t', '\n', '\r', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m128i operators = _mm_setr_epi8('{', '}', '[', ']', ':', ',', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+  classes->quotes = _structural_match_sse42(block, quote, 1);
+  classes->backslashes = _structural_match_sse42(block, backslash, 1);
+  classes->whitespaces = _structural_match_sse42(block, whitespaces, 4);
+  classes->operators = _structural_match_sse42(block, operators, 6);
+}
+
+/**
+ * Classifies a block of 64 bytes with AVX2 instructions, 32 bytes at a time.
+ *
+ * @param const char* block
+ *   The 64 bytes to classify.
+ * @param struct json_structural_block* classes
+ *   Receives the character classes of the block.
+ */
+__attribute__((target("avx2")))
+static void _structural_classify_avx2(const char *block, struct json_structural_block *classes) {
+  uint32_t masks[4][2];
+  for (int i = 0; i < 2; ++i) {
+    const __m256i chunk = _mm256_loadu_si256((const __m256i *)(block + 32 * i));
+    const __m256i quotes = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\"'));
+    const __m256i backslashes = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\\'));
+    const __m256i whitespaces = _mm256_or_si256(
+      _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t'))),
+      _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\r'))));
+    // Brackets fold onto braces once bit 0x20 is set.
+    const __m256i folded = _mm256_or_si256(chunk, _mm256_set1_epi8(0x20));
+    const __m256i operators = _mm256_or_si256(
+      _mm256_or_si256(_mm256_cmpeq_epi8(folded, _mm256_set1_epi8('{')), _mm256_cmpeq_epi8(folded, _mm256_set1_epi8('}'))),
+      _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(':')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(','))));
+    masks[0][i] = (uint32_t)_mm256_movemask_epi8(quotes);
+    masks[1][i] = (uint32_t)_mm256_movemask_epi8(backslashes);
+    masks[2][i] = (uint32_t)_mm256_movemask_epi8(whitespaces);
+    masks[3][i] = (uint32_t)_mm256_movemask_epi8(operators);
+  }
+  classes->quotes = (uint64_t)masks[0][0] | ((uint64_t)masks[0][1] << 32);
+  classes->backslashes = (uint64_t)masks[1][0] | ((uint64_t)masks[1][1] << 32);
+  classes->whitespaces = (uint64_t)masks[2][0] | ((uint64_t)masks[2][1] << 32);
+  classes->operators = (uint64_t)masks[3][0] | ((uint64_t)masks[3][1] << 32);
+}
+
+#endif /* JSON_STRUCTURAL_X86 */
+
+/**
+ * The kernel selected for the running CPU.
+ */
+static void (*_structural_classifier)(const char *, struct json_structural_block *) = NULL;
+
+/**
+ * Selects the fastest classification kernel supported by the running CPU.
+ *
+ * The selection is made once and cached for the following calls.
+ */
+static void _structural_select_classifier() {
+  if (__atomic_load_n(&_structural_classifier, __ATOMIC_RELAXED) != NULL) {
+    return;
+  }
+  void (*classifier)(const char *, struct json_structural_block *) = _structural_classify_scalar;
+#ifdef JSON_STRUCTURAL_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    classifier = _structural_classify_avx2;
+  } else if (__builtin_cpu_supports("sse4.2")) {
+    classifier = _structural_classify_sse42;
+  }
+#endif
+  __atomic_store_n(&_structural_classifier, classifier, __ATOMIC_RELAXED);
+}
+
+/**
+ * Computes the mask of the characters escaped by a backslash.
+ *
+ * A character is escaped when it is preceded by an odd-length run of backslashes.
+ *
+ * @param uint64_t backslashes
+ *   The backslash characters of the block.
+ * @param uint64_t* prev_escaped
+ *   Carries whether the first character of the next block is escaped.
+ *
+ * @return uint64_t
+ *   The mask of the escaped characters.
+ */
+static uint64_t _structural_escaped(uint64_t backslashes, uint64_t *prev_escaped) {
+  const uint64_t even_bits = 0x5555555555555555ULL;
+  // A backslash escaped by the previous block does not start a run.
+  backslashes &= ~*prev_escaped;
+  const uint64_t follows_escape = (backslashes << 1) | *prev_escaped;
+  // Runs of backslashes starting on odd bits.
+  const uint64_t odd_starts = backslashes & ~even_bits & ~follows_escape;
+  uint64_t even_starts_sum = 0;
+  *prev_escaped = __builtin_add_overflow(odd_starts, backslashes, &even_starts_sum) ? 1 : 0;
+  const uint64_t invert_mask = even_starts_sum << 1;
+  return (even_bits ^ invert_mask) & follows_escape;
+}
+
+/**
+ * Computes the prefix XOR of a mask.
+ *
+ * Bit N of the result is the XOR of bits 0 to N of the mask, which turns the
+ * unescaped double quotes into the mask of the characters inside strings.
+ *
+ * @param uint64_t mask
+ *   The mask.
+ *
+ * @return uint64_t
+ *   The prefix XOR of the mask.
+ */
+static uint64_t _structural_prefix_xor(uint64_t mask) {
+  mask ^= mask << 1;
+  mask ^= mask << 2;
+  mask ^= mask << 4;
+  mask ^= mask << 8;
+  mask ^= mask << 16;
+  mask ^= mask << 32;
+  return mask;
+}
+
+/**
+ * Indexes the token starts of the given number of input characters.
+ *
+ * @param struct json_structural_index* index
+ *   The index instance.
+ * @param size_t size
+ *   The number of input characters to index, a multiple of the block size
+ *   unless the window ends the input.
+ *
+ * @return int
+ *   Returns 1 when the window was indexed; otherwise, 0.
+ */
+static int _structural_index_window(struct json_structural_index *index, size_t size) {
+  void (*classify)(const char *, struct json_structural_block *) = __atomic_load_n(&_structural_classifier, __ATOMIC_RELAXED);
+  // A window holds at most one token start per character.
+  if (index->capacity < size) {
+    uint32_t *offsets = (uint32_t *)_json_realloc(index->allocator, index->offsets, size * sizeof(uint32_t));
+    if (offsets == NULL) {
+      return 0;
+    }
+    index->offsets = offsets;
+    index->capacity = size;
+  }
+  index->base = index->indexed;
+  index->count = 0;
+  char padded[JSON_STRUCTURAL_BLOCK_SIZE];
+  for (size_t offset = 0; offset < size; offset += JSON_STRUCTURAL_BLOCK_SIZE) {
+    // Pad the last block with whitespaces.
+    const char *block = index->input + index->base + offset;
+    if (size - offset < JSON_STRUCTURAL_BLOCK_SIZE) {
+      memset(padded, ' ', JSON_STRUCTURAL_BLOCK_SIZE);
+      memcpy(padded, block, size - offset);
+      block = padded;
+    }
+    struct json_structural_block classes;
+    classify(block, &classes);
+    // Find the unescaped double quotes and the characters inside strings.
+    const uint64_t quotes = classes.quotes & ~_structural_escaped(classes.backslashes, &index->prev_escaped);
+    const uint64_t in_string = _structural_prefix_xor(quotes) ^ index->prev_in_string;
+    index->prev_in_string = (uint64_t)0 - (in_string >> 63);
+    // Find the first character of numbers and literals.
+    const uint64_t scalars = ~(classes.operators | classes.whitespaces | quotes | in_string);
+    const uint64_t scalar_starts = scalars & ~((scalars << 1) | index->prev_scalar);
+    index->prev_scalar = scalars >> 63;
+    // Operators outside strings, opening double quotes and scalar starts.
+    uint64_t structurals = (classes.operators & ~in_string) | (quotes & in_string) | scalar_starts;
+    // Write the offsets of the block token starts.
+    while (structurals != 0) {
+      index->offsets[index->count++] = (uint32_t)(offset + (size_t)__builtin_ctzll(structurals));
+      structurals &= structurals - 1;
+    }
+  }
+  index->indexed += size;
+  return 1;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void _json_structural_index_init(struct json_structural_index *index, const char *input, size_t length, const struct json_allocator *allocator) {
+  index->input = input;
+  index->length = length;
+  index->base = 0;
+  index->indexed = 0;
+  index->window = JSON_STRUCTURAL_WINDOW_SIZE;
+  index->prev_escaped = 0;
+  index->prev_in_string = 0;
+  index->prev_scalar = 0;
+  index->offsets = NULL;
+  index->count = 0;
+  index->capacity = 0;
+  index->allocator = allocator;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int _json_structural_index_next_window(struct json_structural_index *index) {
+  _structural_select_classifier();
+  index->count = 0;
+  while (index->count == 0 && index->indexed < index->length) {
+    size_t size = index->length - index->indexed;
+    if (size > index->window) {
+      size = index->window;
+    }
+    if (_structural_index_window(index, size) == 0) {
+      return 0;
+    }
+    // Grow the windows geometrically.
+    if (index->window < JSON_STRUCTURAL_MAX_WINDOW_SIZE) {
+      index->window *= 2;
+    }
+  }
+  return index->count > 0 ? 1 : 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void _json_structural_index_free(struct json_structural_index *index) {
+  _json_free(index->allocator, index->offsets);
+  index->offsets = NULL;
+  index->count = 0;
+  index->capacity = 0;
+}
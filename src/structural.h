@@ -0,0 +1,204 @@
+#ifndef JSON_STRUCTURAL_H
+#define JSON_STRUCTURAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../include/json.h"
+
+/**
+ * The minimum input length in bytes for which the decoder builds a structural index.
+ *
+ * Shorter inputs are tokenized directly, since the index would not pay for itself.
+ */
+#define JSON_STRUCTURAL_INDEX_MIN_LENGTH 256
+
+/**
+ * The number of input bytes classified at once by the structural index kernels.
+ */
+#define JSON_STRUCTURAL_BLOCK_SIZE 64
+
+/**
+ * The number of input bytes indexed by the first window of a structural index.
+ */
+#define JSON_STRUCTURAL_WINDOW_SIZE 4096
+
+/**
+ * The maximum number of input bytes indexed by a window of a structural index.
+ */
+#define JSON_STRUCTURAL_MAX_WINDOW_SIZE 1048576
+
+/**
+ * The data struct definition for the character classes of a 64 bytes block.
+ *
+ * Bit N of every mask describes the byte N of the block.
+ */
+struct json_structural_block {
+
+  /**
+   * The double quote characters.
+   *
+   * @var uint64_t quotes.
+   */
+  uint64_t quotes;
+
+  /**
+   * The backslash characters.
+   *
+   * @var uint64_t backslashes.
+   */
+  uint64_t backslashes;
+
+  /**
+   * The whitespace characters (space, tab, line feed and carriage return).
+   *
+   * @var uint64_t whitespaces.
+   */
+  uint64_t whitespaces;
+
+  /**
+   * The structural operators ({, }, [, ], : and ,).
+   *
+   * @var uint64_t operators.
+   */
+  uint64_t operators;
+};
+
+/**
+ * The data struct definition for a structural index.
+ *
+ * The index is the ordered list of the offsets of every token start in the
+ * input: structural operators, opening double quotes and the first character
+ * of numbers and literals. Characters inside strings are never indexed.
+ *
+ * The input is indexed one window at a time, with windows growing
+ * geometrically, so that decoding a document at the start of a large buffer
+ * only indexes about as many bytes as the document holds.
+ */
+struct json_structural_index {
+
+  /**
+   * The JSON encoded string being indexed.
+   *
+   * @var const char* input.
+   */
+  const char *input;
+
+  /**
+   * The number of characters in the input.
+   *
+   * @var size_t length.
+   */
+  size_t length;
+
+  /**
+   * The position in the input of the current window.
+   *
+   * @var size_t base.
+   */
+  size_t base;
+
+  /**
+   * The number of input characters indexed so far.
+   *
+   * @var size_t indexed.
+   */
+  size_t indexed;
+
+  /**
+   * The number of input characters indexed by the next window.
+   *
+   * @var size_t window.
+   */
+  size_t window;
+
+  /**
+   * Whether the first character of the next block is escaped.
+   *
+   * @var uint64_t prev_escaped.
+   */
+  uint64_t prev_escaped;
+
+  /**
+   * All ones when the next block starts inside a string; otherwise, 0.
+   *
+   * @var uint64_t prev_in_string.
+   */
+  uint64_t prev_in_string;
+
+  /**
+   * Whether the last character of the previous block belongs to a scalar.
+   *
+   * @var uint64_t prev_scalar.
+   */
+  uint64_t prev_scalar;
+
+  /**
+   * The offsets of the token starts of the current window, relative to base.
+   *
+   * @var uint32_t* offsets.
+   */
+  uint32_t *offsets;
+
+  /**
+   * The number of token starts in the index.
+   *
+   * @var size_t count.
+   */
+  size_t count;
+
+  /**
+   * The number of offsets the index can hold before growing.
+   *
+   * @var size_t capacity.
+   */
+  size_t capacity;
+
+  /**
+   * The allocator of the offsets, or NULL for the default allocator.
+   *
+   * @var const struct json_allocator* allocator.
+   */
+  const struct json_allocator *allocator;
+};
+
+/**
+ * Initializes a structural index over the given input.
+ *
+ * No input is indexed until _json_structural_index_next_window() is called.
+ *
+ * @param struct json_structural_index* index
+ *   The index to initialize. It must be released with _json_structural_index_free().
+ * @param const char* input
+ *   The JSON encoded string.
+ * @param size_t length
+ *   The number of characters in the input.
+ * @param const struct json_allocator* allocator
+ *   The allocator of the offsets, or NULL for the default allocator.
+ */
+void _json_structural_index_init(struct json_structural_index *index, const char *input, size_t length, const struct json_allocator *allocator);
+
+/**
+ * Replaces the offsets of the index with the token starts of the next window.
+ *
+ * The input is classified 64 bytes at a time by the fastest kernel supported
+ * by the running CPU (AVX2, SSE4.2 or a portable scalar fallback). Windows
+ * without any token start are skipped.
+ *
+ * @param struct json_structural_index* index
+ *   The index instance.
+ *
+ * @return int
+ *   Returns 1 when token starts were indexed; otherwise, 0 once the input is
+ *   exhausted or on allocation failures.
+ */
+int _json_structural_index_next_window(struct json_structural_index *index);
+
+/**
+ * Releases the memory of a structural index.
+ *
+ * @param struct json_structural_index* index
+ *   The index to release.
+ */
+void _json_structural_index_free(struct json_structural_index *index);
+
+#endif /* JSON_STRUCTURAL_H */
@@ -0,0 +1,753 @@
+#include <stdlib.h>
+#include <string.h>
+#include "allocator.h"
+#include "decoder.h"
+#include "escape.h"
+#include "number.h"
+#include "path.h"
+#include "tape.h"
+
+/**
+ * The data struct definition for the state of a tape being built.
+ */
+struct json_tape_builder {
+
+  /**
+   * The tape being built.
+   *
+   * @var struct json_tape* tape.
+   */
+  struct json_tape *tape;
+
+  /**
+   * The indexes of the start words of the open containers.
+   *
+   * @var size_t* starts.
+   */
+  size_t *starts;
+
+  /**
+   * The number of open containers.
+   *
+   * @var size_t depth.
+   */
+  size_t depth;
+
+  /**
+   * The number of indexes the starts stack can hold.
+   *
+   * @var size_t capacity.
+   */
+  size_t capacity;
+
+  /**
+   * Whether strings must be valid JSON string content.
+   *
+   * @var int strict.
+   */
+  int strict;
+};
+
+/**
+ * Returns the tag of a tape word.
+ *
+ * @param uint64_t word
+ *   The tape word.
+ *
+ * @return int
+ *   The JSON_TAPE_* tag.
+ */
+static int _tape_tag(uint64_t word) {
+  return (int)(word >> JSON_TAPE_PAYLOAD_BITS);
+}
+
+/**
+ * Returns the payload of a tape word.
+ *
+ * @param uint64_t word
+ *   The tape word.
+ *
+ * @return size_t
+ *   The payload.
+ */
+static size_t _tape_payload(uint64_t word) {
+  return (size_t)(word & (((uint64_t)1 << JSON_TAPE_PAYLOAD_BITS) - 1));
+}
+
+/**
+ * Appends a word to the tape.
+ *
+ * @param struct json_tape* tape
+ *   The tape instance.
+ * @param uint64_t word
+ *   The word to append.
+ *
+ * @return int
+ *   Returns 1 when the word was appended; otherwise, 0.
+ */
+static int _tape_append(struct json_tape *tape, uint64_t word) {
+  if (tape->length == tape->capacity) {
+    const size_t capacity = tape->capacity * 2;
+    uint64_t *words = (uint64_t *)_json_realloc(NULL, tape->words, capacity * sizeof(uint64_t));
+    if (words == NULL) {
+      return 0;
+    }
+    tape->words = words;
+    tape->capacity = capacity;
+  }
+  tape->words[tape->length++] = word;
+  return 1;
+}
+
+/**
+ * Appends a tagged word to the tape.
+ *
+ * @param struct json_tape* tape
+ *   The tape instance.
+ * @param int tag
+ *   The JSON_TAPE_* tag.
+ * @param size_t payload
+ *   The payload, below 2^56.
+ *
+ * @return int
+ *   Returns 1 when the word was appended; otherwise, 0.
+ */
+static int _tape_append_tag(struct json_tape *tape, int tag, size_t payload) {
+  return _tape_append(tape, ((uint64_t)tag << JSON_TAPE_PAYLOAD_BITS) | (uint64_t)payload);
+}
+
+/**
+ * Unescapes a key or string into the string buffer and appends its word.
+ *
+ * @param struct json_tape_builder* builder
+ *   The builder instance.
+ * @param int tag
+ *   JSON_TAPE_KEY or JSON_TAPE_STRING.
+ * @param const char* characters
+ *   The characters between the double quotes.
+ * @param size_t length
+ *   The number of characters.
+ *
+ * @return int
+ *   Returns 1 when the string was appended; otherwise, 0.
+ */
+static int _tape_append_string(struct json_tape_builder *builder, int tag, const char *characters, size_t length) {
+  struct json_tape *tape = builder->tape;
+  if (length > UINT32_MAX) {
+    return 0;
+  }
+  // Unescaped strings are never longer than their source.
+  const size_t required = tape->strings_length + sizeof(uint32_t) + length + 1;
+  if (required > tape->strings_capacity) {
+    size_t capacity = tape->strings_capacity * 2;
+    while (capacity < required) {
+      capacity *= 2;
+    }
+    char *strings = (char *)_json_realloc(NULL, tape->strings, capacity);
+    if (strings == NULL) {
+      return 0;
+    }
+    tape->strings = strings;
+    tape->strings_capacity = capacity;
+  }
+  const size_t offset = tape->strings_length;
+  char *destination = tape->strings + offset + sizeof(uint32_t);
+  size_t written = 0;
+  if (_json_unescape_string(destination, characters, length, builder->strict, &written) == 0) {
+    return 0;
+  }
+  const uint32_t written_length = (uint32_t)written;
+  memcpy(tape->strings + offset, &written_length, sizeof(uint32_t));
+  destination[written] = '\0';
+  tape->strings_length = offset + sizeof(uint32_t) + written + 1;
+  return _tape_append_tag(tape, tag, offset);
+}
+
+/**
+ * Opens a container on the tape.
+ *
+ * @param struct json_tape_builder* builder
+ *   The builder instance.
+ * @param int tag
+ *   JSON_TAPE_OBJECT_START or JSON_TAPE_ARRAY_START.
+ *
+ * @return int
+ *   Returns 1 when the container was opened; otherwise, 0.
+ */
+static int _tape_open(struct json_tape_builder *builder, int tag) {
+  if (builder->depth == builder->capacity) {
+    const size_t capacity = builder->capacity == 0 ? 32 : builder->capacity * 2;
+    size_t *starts = (size_t *)_json_realloc(NULL, builder->starts, capacity * sizeof(size_t));
+    if (starts == NULL) {
+      return 0;
+    }
+    builder->starts = starts;
+    builder->capacity = capacity;
+  }
+  // The start word is patched with the index following the end word on close.
+  builder->starts[builder->depth++] = builder->tape->length;
+  return _tape_append_tag(builder->tape, tag, 0);
+}
+
+/**
+ * Closes the innermost container on the tape.
+ *
+ * @param struct json_tape_builder* builder
+ *   The builder instance.
+ * @param int tag
+ *   JSON_TAPE_OBJECT_END or JSON_TAPE_ARRAY_END.
+ *
+ * @return int
+ *   Returns 1 when the container was closed; otherwise, 0.
+ */
+static int _tape_close(struct json_tape_builder *builder, int tag) {
+  struct json_tape *tape = builder->tape;
+  const size_t start = builder->starts[--builder->depth];
+  if (_tape_append_tag(tape, tag, start) == 0) {
+    return 0;
+  }
+  tape->words[start] |= (uint64_t)tape->length;
+  return 1;
+}
+
+/**
+ * Handles the start of an object.
+ *
+ * @param void* context
+ *   The builder instance.
+ *
+ * @return int
+ *   Returns 1 on success; otherwise, 0.
+ */
+static int _tape_object_start(void *context) {
+  return _tape_open((struct json_tape_builder *)context, JSON_TAPE_OBJECT_START);
+}
+
+/**
+ * Handles the end of an object.
+ *
+ * @param void* context
+ *   The builder instance.
+ *
+ * @return int
+ *   Returns 1 on success; otherwise, 0.
+ */
+static int _tape_object_end(void *context) {
+  return _tape_close((struct json_tape_builder *)context, JSON_TAPE_OBJECT_END);
+}
+
+/**
+ * Handles the start of an array.
+ *
+ * @param void* context
+ *   The builder instance.
+ *
+ * @return int
+ *   Returns 1 on success; otherwise, 0.
+ */
+static int _tape_array_start(void *context) {
+  return _tape_open((struct json_tape_builder *)context, JSON_TAPE_ARRAY_START);
+}
+
+/**
+ * Handles the end of an array.
+ *
+ * @param void* context
+ *   The builder instance.
+ *
+ * @return int
+ *   Returns 1 on success; otherwise, 0.
+ */
+static int _tape_array_end(void *context) {
+  return _tape_close((struct json_tape_builder *)context, JSON_TAPE_ARRAY_END);
+}
+
+/**
+ * Handles an object key.
+ *
+ * @param void* context
+ *   The builder instance.
+ * @param const char* key
+ *   The key characters.
+ * @param size_t length
+ *   The number of key characters.
+ *
+ * @return int
+ *   Returns 1 on success; otherwise, 0.
+ */
+static int _tape_key(void *context, const char *key, size_t length) {
+  return _tape_append_string((struct json_tape_builder *)context, JSON_TAPE_KEY, key, length);
+}
+
+/**
+ * Handles a string value.
+ *
+ * @param void* context
+ *   The builder instance.
+ * @param const char* value
+ *   The string characters.
+ * @param size_t length
+ *   The number of string characters.
+ *
+ * @return int
+ *   Returns 1 on success; otherwise, 0.
+ */
+static int _tape_string(void *context, const char *value, size_t length) {
+  return _tape_append_string((struct json_tape_builder *)context, JSON_TAPE_STRING, value, length);
+}
+
+/**
+ * Handles a number value that is not an exact integer.
+ *
+ * @param void* context
+ *   The builder instance.
+ * @param double value
+ *   The number value.
+ *
+ * @return int
+ *   Returns 1 on success; otherwise, 0.
+ */
+static int _tape_number(void *context, double value) {
+  struct json_tape *tape = ((struct json_tape_builder *)context)->tape;
+  uint64_t bits = 0;
+  memcpy(&bits, &value, sizeof(bits));
+  return _tape_append_tag(tape, JSON_TAPE_DOUBLE, 0) && _tape_append(tape, bits);
+}
+
+/**
+ * Handles an integer value that fits an int64_t.
+ *
+ * @param void* context
+ *   The builder instance.
+ * @param int64_t value
+ *   The integer value.
+ *
+ * @return int
+ *   Returns 1 on success; otherwise, 0.
+ */
+static int _tape_integer(void *context, int64_t value) {
+  struct json_tape *tape = ((struct json_tape_builder *)context)->tape;
+  return _tape_append_tag(tape, JSON_TAPE_INTEGER, 0) && _tape_append(tape, (uint64_t)value);
+}
+
+/**
+ * Handles an integer value that only fits an uint64_t.
+ *
+ * @param void* context
+ *   The builder instance.
+ * @param uint64_t value
+ *   The integer value.
+ *
+ * @return int
+ *   Returns 1 on success; otherwise, 0.
+ */
+static int _tape_unsigned(void *context, uint64_t value) {
+  struct json_tape *tape = ((struct json_tape_builder *)context)->tape;
+  return _tape_append_tag(tape, JSON_TAPE_UNSIGNED, 0) && _tape_append(tape, value);
+}
+
+/**
+ * Handles a boolean value.
+ *
+ * @param void* context
+ *   The builder instance.
+ * @param int value
+ *   The boolean value.
+ *
+ * @return int
+ *   Returns 1 on success; otherwise, 0.
+ */
+static int _tape_boolean(void *context, int value) {
+  return _tape_append_tag(((struct json_tape_builder *)context)->tape, value ? JSON_TAPE_TRUE : JSON_TAPE_FALSE, 0);
+}
+
+/**
+ * Handles a null value.
+ *
+ * @param void* context
+ *   The builder instance.
+ *
+ * @return int
+ *   Returns 1 on success; otherwise, 0.
+ */
+static int _tape_null(void *context) {
+  return _tape_append_tag(((struct json_tape_builder *)context)->tape, JSON_TAPE_NULL, 0);
+}
+
+/**
+ * The event handler writing decoded values to a tape.
+ */
+static const struct json_sax_handler _tape_handler = {
+  _tape_object_start,
+  _tape_object_end,
+  _tape_array_start,
+  _tape_array_end,
+  _tape_key,
+  _tape_string,
+  _tape_number,
+  _tape_boolean,
+  _tape_null,
+  _tape_integer,
+  _tape_unsigned
+};
+
+/**
+ * Returns the index of the word following a value.
+ *
+ * @param const struct json_tape* tape
+ *   The tape instance.
+ * @param size_t index
+ *   The index of the first word of the value.
+ *
+ * @return size_t
+ *   The index of the word following the value.
+ */
+static size_t _tape_skip(const struct json_tape *tape, size_t index) {
+  const uint64_t word = tape->words[index];
+  switch (_tape_tag(word)) {
+    case JSON_TAPE_OBJECT_START:
+    case JSON_TAPE_ARRAY_START:
+      return _tape_payload(word);
+    case JSON_TAPE_DOUBLE:
+    case JSON_TAPE_INTEGER:
+    case JSON_TAPE_UNSIGNED:
+      return index + 2;
+    default:
+      return index + 1;
+  }
+}
+
+/**
+ * Returns the characters of a key or string word.
+ *
+ * @param const struct json_tape* tape
+ *   The tape instance.
+ * @param size_t index
+ *   The index of the key or string word.
+ * @param size_t* length
+ *   Receives the number of characters. May be NULL.
+ *
+ * @return const char*
+ *   The NUL terminated characters.
+ */
+static const char *_tape_characters(const struct json_tape *tape, size_t index, size_t *length) {
+  const char *string = tape->strings + _tape_payload(tape->words[index]);
+  if (length != NULL) {
+    uint32_t string_length = 0;
+    memcpy(&string_length, string, sizeof(uint32_t));
+    *length = string_length;
+  }
+  return string + sizeof(uint32_t);
+}
+
+/**
+ * Moves a value to the member or element a path segment selects.
+ *
+ * @param struct json_tape_value* value
+ *   The container value, replaced by the selected value.
+ * @param const char* key
+ *   The key of the segment.
+ * @param size_t length
+ *   The number of characters in the key.
+ * @param int is_index
+ *   Whether the key is an array index.
+ * @param size_t position
+ *   The array index.
+ *
+ * @return int
+ *   Returns 1 when the value was found; otherwise, 0.
+ */
+static int _tape_step(struct json_tape_value *value, const char *key, size_t length, int is_index, size_t position) {
+  const struct json_tape *tape = value->tape;
+  const int tag = _tape_tag(tape->words[value->index]);
+  if (tag == JSON_TAPE_ARRAY_START && is_index) {
+    struct json_tape_value element;
+    int found = json_tape_first(*value, &element);
+    while (found && position > 0) {
+      found = json_tape_next(&element);
+      position--;
+    }
+    if (found) {
+      *value = element;
+    }
+    return found;
+  }
+  if (tag != JSON_TAPE_OBJECT_START) {
+    return 0;
+  }
+  // Compare the keys by length first.
+  struct json_tape_value member;
+  for (int found = json_tape_first(*value, &member); found; found = json_tape_next(&member)) {
+    size_t member_length = 0;
+    const char *member_key = _tape_characters(tape, member.key, &member_length);
+    if (member_length == length && memcmp(member_key, key, length) == 0) {
+      *value = member;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct json_tape *json_tape_decode(const char *buffer, size_t length, size_t *offset, const struct json_decode_options *options) {
+  if (buffer == NULL) {
+    return NULL;
+  }
+  // Size the tape and the string buffer for the typical density of JSON text.
+  struct json_tape *tape = (struct json_tape *)_json_alloc(NULL, sizeof(struct json_tape));
+  if (tape == NULL) {
+    return NULL;
+  }
+  tape->capacity = length / 4 + 16;
+  tape->length = 0;
+  tape->words = (uint64_t *)_json_alloc(NULL, tape->capacity * sizeof(uint64_t));
+  tape->strings_capacity = length / 2 + 64;
+  tape->strings_length = 0;
+  tape->strings = (char *)_json_alloc(NULL, tape->strings_capacity);
+  if (tape->words == NULL || tape->strings == NULL) {
+    json_tape_free(tape);
+    return NULL;
+  }
+  struct json_tape_builder builder = {tape, NULL, 0, 0, 0};
+  // Init the decoder instance.
+  struct json_decoder decoder;
+  _decoder_init(&decoder, buffer, length, NULL);
+  if (options != NULL && options->max_depth > 0) {
+    decoder.max_depth = options->max_depth;
+  }
+  if (options != NULL) {
+    decoder.flags = options->flags;
+    decoder.allocator = options->allocator;
+    builder.strict = (options->flags & JSON_DECODE_STRICT) != 0;
+  }
+  decoder.handler = &_tape_handler;
+  decoder.context = &builder;
+  decoder.handler_validates = 1;
+  // Write the decoded values to the tape.
+  const int status = _decoder_parse(&decoder);
+  _json_free(NULL, builder.starts);
+  // Report where decoding stopped.
+  if (offset != NULL) {
+    *offset = status == 1 ? decoder.position + 1 : decoder.position;
+  }
+  if (status == 0) {
+    json_tape_free(tape);
+    return NULL;
+  }
+  return tape;
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct json_tape_value json_tape_root(const struct json_tape *tape) {
+  struct json_tape_value value = {tape, 0, SIZE_MAX};
+  return value;
+}
+
+/**
+ * {@inheritdoc}
+ */
+enum JSONDataType json_tape_type(struct json_tape_value value) {
+  switch (_tape_tag(value.tape->words[value.index])) {
+    case JSON_TAPE_OBJECT_START:
+      return JSON_object;
+    case JSON_TAPE_ARRAY_START:
+      return JSON_array;
+    case JSON_TAPE_STRING:
+      return JSON_string;
+    case JSON_TAPE_DOUBLE:
+    case JSON_TAPE_INTEGER:
+    case JSON_TAPE_UNSIGNED:
+      return JSON_number;
+    case JSON_TAPE_TRUE:
+    case JSON_TAPE_FALSE:
+      return JSON_boolean;
+    default:
+      return JSON_null;
+  }
+}
+
+/**
+ * {@inheritdoc}
+ */
+int json_tape_first(struct json_tape_value container, struct json_tape_value *child) {
+  const struct json_tape *tape = container.tape;
+  const int tag = _tape_tag(tape->words[container.index]);
+  if (tag != JSON_TAPE_OBJECT_START && tag != JSON_TAPE_ARRAY_START) {
+    return 0;
+  }
+  // Empty containers end right after their start word.
+  const size_t index = container.index + 1;
+  const int next = _tape_tag(tape->words[index]);
+  if (next == JSON_TAPE_OBJECT_END || next == JSON_TAPE_ARRAY_END) {
+    return 0;
+  }
+  child->tape = tape;
+  child->key = tag == JSON_TAPE_OBJECT_START ? index : SIZE_MAX;
+  child->index = tag == JSON_TAPE_OBJECT_START ? index + 1 : index;
+  return 1;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int json_tape_next(struct json_tape_value *value) {
+  const struct json_tape *tape = value->tape;
+  const size_t index = _tape_skip(tape, value->index);
+  const int tag = _tape_tag(tape->words[index]);
+  if (tag == JSON_TAPE_OBJECT_END || tag == JSON_TAPE_ARRAY_END) {
+    return 0;
+  }
+  // Object members are preceded by their key.
+  if (value->key != SIZE_MAX) {
+    value->key = index;
+    value->index = index + 1;
+  } else {
+    value->index = index;
+  }
+  return 1;
+}
+
+/**
+ * {@inheritdoc}
+ */
+const char *json_tape_key(struct json_tape_value value, size_t *length) {
+  if (value.key == SIZE_MAX) {
+    return NULL;
+  }
+  return _tape_characters(value.tape, value.key, length);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int json_tape_find(struct json_tape_value object, const char *path, const char delimiter, struct json_tape_value *result) {
+  if (path == NULL || result == NULL) {
+    return 0;
+  }
+  // Walk the segments in place, skipping empty ones.
+  int segments = 0;
+  const char *key = path;
+  while (*key != '\0') {
+    if (*key == delimiter) {
+      key++;
+      continue;
+    }
+    const char *end = key;
+    size_t position = 0;
+    int is_index = 1;
+    while (*end != '\0' && *end != delimiter) {
+      const unsigned digit = (unsigned char)*end - '0';
+      if (digit > 9 || position > (SIZE_MAX - digit) / 10) {
+        is_index = 0;
+      } else {
+        position = position * 10 + digit;
+      }
+      end++;
+    }
+    if (_tape_step(&object, key, (size_t)(end - key), is_index, position) == 0) {
+      return 0;
+    }
+    segments++;
+    key = end;
+  }
+  if (segments == 0) {
+    return 0;
+  }
+  *result = object;
+  return 1;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int json_tape_path_eval(struct json_tape_value object, const struct json_path *path, struct json_tape_value *result) {
+  if (path == NULL || result == NULL) {
+    return 0;
+  }
+  for (size_t i = 0; i < path->count; i++) {
+    const struct json_path_segment *segment = &path->segments[i];
+    if (_tape_step(&object, segment->key, segment->length, segment->is_index, segment->index) == 0) {
+      return 0;
+    }
+  }
+  *result = object;
+  return 1;
+}
+
+/**
+ * {@inheritdoc}
+ */
+const char *json_tape_string(struct json_tape_value value, size_t *length) {
+  if (_tape_tag(value.tape->words[value.index]) != JSON_TAPE_STRING) {
+    return NULL;
+  }
+  return _tape_characters(value.tape, value.index, length);
+}
+
+/**
+ * {@inheritdoc}
+ */
+double json_tape_number(struct json_tape_value value) {
+  // Only numbers are followed by a payload word.
+  const uint64_t *words = value.tape->words + value.index;
+  switch (_tape_tag(words[0])) {
+    case JSON_TAPE_DOUBLE: {
+      double number = 0;
+      memcpy(&number, &words[1], sizeof(number));
+      return number;
+    }
+    case JSON_TAPE_INTEGER:
+      return (double)(int64_t)words[1];
+    case JSON_TAPE_UNSIGNED:
+      return (double)words[1];
+    default:
+      return 0;
+  }
+}
+
+/**
+ * {@inheritdoc}
+ */
+int64_t json_tape_integer(struct json_tape_value value) {
+  switch (_tape_tag(value.tape->words[value.index])) {
+    case JSON_TAPE_INTEGER:
+      return (int64_t)value.tape->words[value.index + 1];
+    case JSON_TAPE_UNSIGNED:
+      // Unsigned integers are above INT64_MAX.
+      return INT64_MAX;
+    case JSON_TAPE_DOUBLE:
+      return _json_double_to_int64(json_tape_number(value));
+    default:
+      return 0;
+  }
+}
+
+/**
+ * {@inheritdoc}
+ */
+int json_tape_bool(struct json_tape_value value) {
+  return _tape_tag(value.tape->words[value.index]) == JSON_TAPE_TRUE;
+}
+
+/**
+ * {@inheritdoc}
+ */
+size_t json_tape_memory(const struct json_tape *tape) {
+  return sizeof(struct json_tape) + tape->length * sizeof(uint64_t) + tape->strings_length;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void json_tape_free(struct json_tape *tape) {
+  if (tape == NULL) {
+    return;
+  }
+  _json_free(NULL, tape->words);
+  _json_free(NULL, tape->strings);
+  _json_free(NULL, tape);
+}
@@ -0,0 +1,83 @@
+#ifndef JSON_TAPE_INTERNAL_H
+#define JSON_TAPE_INTERNAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../include/json.h"
+
+/**
+ * The number of bits of a tape word holding its payload, below the tag byte.
+ */
+#define JSON_TAPE_PAYLOAD_BITS 56
+
+/**
+ * Tape word tags.
+ *
+ * Object and array starts hold the index of the word following their end,
+ * so that containers are skipped in a single step, and ends hold the index of
+ * their start. Keys and strings hold the offset of their characters in the
+ * string buffer. Numbers are followed by a second word holding their value.
+ */
+#define JSON_TAPE_OBJECT_START '{'
+#define JSON_TAPE_OBJECT_END '}'
+#define JSON_TAPE_ARRAY_START '['
+#define JSON_TAPE_ARRAY_END ']'
+#define JSON_TAPE_KEY ':'
+#define JSON_TAPE_STRING '"'
+#define JSON_TAPE_DOUBLE 'd'
+#define JSON_TAPE_INTEGER 'l'
+#define JSON_TAPE_UNSIGNED 'u'
+#define JSON_TAPE_TRUE 't'
+#define JSON_TAPE_FALSE 'f'
+#define JSON_TAPE_NULL 'n'
+
+/**
+ * The data struct definition for a JSON tape.
+ */
+struct json_tape {
+
+  /**
+   * The tape words, each a tag byte above a 56-bit payload.
+   *
+   * @var uint64_t* words.
+   */
+  uint64_t *words;
+
+  /**
+   * The number of tape words.
+   *
+   * @var size_t length.
+   */
+  size_t length;
+
+  /**
+   * The number of words the tape can hold.
+   *
+   * @var size_t capacity.
+   */
+  size_t capacity;
+
+  /**
+   * The string buffer: for every key and string, its length as a 32-bit
+   * integer, its unescaped characters and a NUL terminator.
+   *
+   * @var char* strings.
+   */
+  char *strings;
+
+  /**
+   * The number of bytes used in the string buffer.
+   *
+   * @var size_t strings_length.
+   */
+  size_t strings_length;
+
+  /**
+   * The number of bytes the string buffer can hold.
+   *
+   * @var size_t strings_capacity.
+   */
+  size_t strings_capacity;
+};
+
+#endif /* JSON_TAPE_INTERNAL_H */
@@ -0,0 +1,75 @@
+#include <stdlib.h>
+#include "allocator.h"
+#include "node.h"
+#include "vector.h"
+
+/**
+ * {@inheritdoc}
+ */
+size_t _json_vector_size(size_t capacity) {
+  return sizeof(struct json_vector) + capacity * sizeof(struct json *);
+}
+
+/**
+ * {@inheritdoc}
+ */
+void _json_vector_fill(struct json_vector *vector, size_t capacity, struct json *first) {
+  vector->count = 0;
+  vector->capacity = capacity;
+  for (struct json *element = first; element != NULL; element = element->next) {
+    vector->elements[vector->count++] = element;
+  }
+}
+
+/**
+ * {@inheritdoc}
+ */
+struct json_vector *_json_vector_get(struct json *array) {
+  struct json_vector *vector = (struct json_vector *)_json_children_extension(array);
+  if (vector != NULL || (array->flags & JSON_FLAG_ARENA) != 0) {
+    return vector;
+  }
+  const size_t count = _json_children_count(array);
+  if (count < JSON_VECTOR_MIN_ELEMENTS) {
+    return NULL;
+  }
+  vector = (struct json_vector *)_json_alloc(NULL, _json_vector_size(count));
+  if (vector == NULL) {
+    return NULL;
+  }
+  _json_vector_fill(vector, count, (struct json *)array->value);
+  // Publish the vector, unless a concurrent access already did.
+  if (_json_children_publish(array, vector) == 0) {
+    _json_free(NULL, vector);
+    return (struct json_vector *)_json_children_extension(array);
+  }
+  return vector;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void _json_vector_push(struct json *array, struct json *element) {
+  struct json_vector *vector = (struct json_vector *)_json_children_extension(array);
+  if (vector == NULL) {
+    return;
+  }
+  if (vector->count < vector->capacity) {
+    vector->elements[vector->count++] = element;
+    return;
+  }
+  // Vectors carved from a document arena cannot grow.
+  if ((array->flags & JSON_FLAG_ARENA) != 0) {
+    _json_children_set_count(array, vector->count + 1);
+    return;
+  }
+  struct json_vector *grown = (struct json_vector *)_json_realloc(NULL, vector, _json_vector_size(vector->capacity * 2));
+  if (grown == NULL) {
+    _json_children_set_count(array, vector->count + 1);
+    _json_free(NULL, vector);
+    return;
+  }
+  grown->capacity *= 2;
+  grown->elements[grown->count++] = element;
+  _json_children_set_extension(array, grown);
+}
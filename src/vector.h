@@ -0,0 +1,94 @@
+#ifndef JSON_VECTOR_H
+#define JSON_VECTOR_H
+
+#include <stddef.h>
+#include "../include/json.h"
+
+/**
+ * The number of elements from which an array gets a vector of its elements.
+ *
+ * Shorter arrays are walked, which is as fast as reading the vector.
+ */
+#define JSON_VECTOR_MIN_ELEMENTS 8
+
+/**
+ * The data struct definition for the vector of the elements of an array.
+ */
+struct json_vector {
+
+  /**
+   * The number of elements; see _json_children_count().
+   *
+   * @var size_t count.
+   */
+  size_t count;
+
+  /**
+   * The number of elements the vector can hold.
+   *
+   * @var size_t capacity.
+   */
+  size_t capacity;
+
+  /**
+   * The elements, in array order.
+   *
+   * @var struct json* elements[].
+   */
+  struct json *elements[];
+};
+
+/**
+ * Returns the size in bytes of a vector holding the given number of elements.
+ *
+ * @param size_t capacity
+ *   The number of elements the vector can hold.
+ *
+ * @return size_t
+ *   The size in bytes.
+ */
+size_t _json_vector_size(size_t capacity);
+
+/**
+ * Fills a vector with the elements of an array chain.
+ *
+ * @param struct json_vector* vector
+ *   The vector, large enough to hold every element.
+ * @param size_t capacity
+ *   The number of elements the vector can hold.
+ * @param struct json* first
+ *   The first element of the array.
+ */
+void _json_vector_fill(struct json_vector *vector, size_t capacity, struct json *first);
+
+/**
+ * Returns the vector of the elements of an array, building it if needed.
+ *
+ * Arrays with at least JSON_VECTOR_MIN_ELEMENTS elements get a vector the
+ * first time they are accessed by index. The vector is published atomically,
+ * so concurrent readers may access the same array.
+ *
+ * @param struct json* array
+ *   The JSON array node.
+ *
+ * @return struct json_vector*
+ *   The vector, or NULL for short arrays (and arrays carved from a document
+ *   arena, whose vector is built at decode time).
+ */
+struct json_vector *_json_vector_get(struct json *array);
+
+/**
+ * Adds an element, already linked at the end of the array, to the array vector.
+ *
+ * Does nothing for arrays without a vector, whose number of elements is kept
+ * by the caller. When the vector cannot grow, it is dropped and rebuilt on the
+ * next access by index.
+ *
+ * @param struct json* array
+ *   The JSON array node.
+ * @param struct json* element
+ *   The element to add.
+ */
+void _json_vector_push(struct json *array, struct json *element);
+
+#endif /* JSON_VECTOR_H */
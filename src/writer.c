@@ -0,0 +1,160 @@
+#include <errno.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "allocator.h"
+#include "writer.h"
+
+/**
+ * Hands the given characters to the sink.
+ *
+ * @param struct json_sink* sink
+ *   The destination.
+ * @param const char* data
+ *   The characters to write.
+ * @param size_t length
+ *   The number of characters to write.
+ *
+ * @return int
+ *   Returns 1 when every character was written; otherwise, 0.
+ */
+static int _writer_sink_write(struct json_sink *sink, const char *data, size_t length) {
+  if (length == 0) {
+    return 1;
+  }
+  // Counting sinks only measure the characters.
+  if (sink->type == JSON_SINK_COUNT) {
+    sink->length += length;
+    return 1;
+  }
+  if (sink->type == JSON_SINK_CALLBACK) {
+    if (sink->write == NULL || sink->write(sink->context, data, length) == 0) {
+      return 0;
+    }
+    sink->length += length;
+    return 1;
+  }
+  // Retry interrupted and partial writes.
+  while (length > 0) {
+    ssize_t written = write(sink->fd, data, length);
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    if (written <= 0) {
+      return 0;
+    }
+    data += written;
+    length -= (size_t)written;
+    sink->length += (size_t)written;
+  }
+  return 1;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int _writer_init(struct json_writer *writer, struct json_sink *sink, const struct json_allocator *allocator) {
+  writer->sink = sink;
+  writer->allocator = allocator;
+  writer->length = 0;
+  // Fixed buffers are written straight into.
+  if (sink != NULL && sink->type == JSON_SINK_BUFFER) {
+    writer->buffer = sink->buffer;
+    writer->capacity = sink->buffer != NULL ? sink->capacity : 0;
+    sink->length = 0;
+    return 1;
+  }
+  writer->capacity = sink == NULL ? 128 : sink->type == JSON_SINK_COUNT ? JSON_WRITER_COUNT_BUFFER_SIZE : JSON_WRITER_BUFFER_SIZE;
+  writer->buffer = (char *)_json_alloc(writer->allocator, writer->capacity);
+  if (sink != NULL) {
+    sink->length = 0;
+  }
+  return writer->buffer != NULL;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int _writer_reserve(struct json_writer *writer, size_t length) {
+  if (writer->capacity - writer->length >= length) {
+    return 1;
+  }
+  // Grow the string of writers without a sink.
+  if (writer->sink == NULL) {
+    size_t capacity = writer->capacity * 2;
+    while (capacity - writer->length < length) {
+      capacity *= 2;
+    }
+    char *buffer = (char *)_json_realloc(writer->allocator, writer->buffer, capacity);
+    if (buffer == NULL) {
+      return 0;
+    }
+    writer->buffer = buffer;
+    writer->capacity = capacity;
+    return 1;
+  }
+  // Fixed buffers cannot make room.
+  if (writer->sink->type == JSON_SINK_BUFFER) {
+    return 0;
+  }
+  // Hand the batch to the sink.
+  if (_writer_sink_write(writer->sink, writer->buffer, writer->length) == 0) {
+    return 0;
+  }
+  writer->length = 0;
+  return writer->capacity >= length;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int _writer_write_large(struct json_writer *writer, const char *data, size_t length) {
+  // Characters larger than the batch buffer go to the sink directly.
+  if (writer->sink != NULL && writer->sink->type != JSON_SINK_BUFFER && length > writer->capacity) {
+    if (_writer_sink_write(writer->sink, writer->buffer, writer->length) == 0) {
+      return 0;
+    }
+    writer->length = 0;
+    return _writer_sink_write(writer->sink, data, length);
+  }
+  if (_writer_reserve(writer, length) == 0) {
+    return 0;
+  }
+  memcpy(writer->buffer + writer->length, data, length);
+  writer->length += length;
+  return 1;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int _writer_finish(struct json_writer *writer) {
+  // NUL terminate strings and fixed buffers with room left.
+  if (writer->sink == NULL || writer->sink->type == JSON_SINK_BUFFER) {
+    if (writer->sink == NULL && _writer_reserve(writer, 1) == 0) {
+      _writer_release(writer);
+      return 0;
+    }
+    if (writer->length < writer->capacity) {
+      writer->buffer[writer->length] = '\0';
+    }
+    if (writer->sink != NULL) {
+      writer->sink->length = writer->length;
+    }
+    return 1;
+  }
+  int status = _writer_sink_write(writer->sink, writer->buffer, writer->length);
+  _writer_release(writer);
+  return status;
+}
+
+/**
+ * {@inheritdoc}
+ */
+void _writer_release(struct json_writer *writer) {
+  if (writer->sink == NULL || writer->sink->type != JSON_SINK_BUFFER) {
+    _json_free(writer->allocator, writer->buffer);
+  }
+  writer->buffer = NULL;
+  writer->length = 0;
+  writer->capacity = 0;
+}
@@ -0,0 +1,167 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stddef.h>
+#include <string.h>
+#include "../include/json.h"
+
+/**
+ * The size in bytes of the buffer batching the writes to callback and file
+ * descriptor sinks.
+ */
+#define JSON_WRITER_BUFFER_SIZE 65536
+
+/**
+ * The size in bytes of the scratch buffer of writers handing characters to a counting sink.
+ */
+#define JSON_WRITER_COUNT_BUFFER_SIZE 4096
+
+/**
+ * The data struct definition for the buffered output of the encoder.
+ */
+struct json_writer {
+
+  /**
+   * The buffered characters.
+   *
+   * @var char* buffer.
+   */
+  char *buffer;
+
+  /**
+   * The number of buffered characters.
+   *
+   * @var size_t length.
+   */
+  size_t length;
+
+  /**
+   * The number of characters the buffer can hold.
+   *
+   * @var size_t capacity.
+   */
+  size_t capacity;
+
+  /**
+   * The destination of the characters, or NULL to grow the buffer instead.
+   *
+   * @var struct json_sink* sink.
+   */
+  struct json_sink *sink;
+
+  /**
+   * The allocator of the buffer, or NULL for the default allocator.
+   *
+   * @var const struct json_allocator* allocator.
+   */
+  const struct json_allocator *allocator;
+};
+
+/**
+ * Initializes a writer over the given sink.
+ *
+ * @param struct json_writer* writer
+ *   The writer instance.
+ * @param struct json_sink* sink
+ *   The destination, or NULL to collect the characters in a growing string.
+ * @param const struct json_allocator* allocator
+ *   The allocator of the buffer, or NULL for the default allocator.
+ *
+ * @return int
+ *   Returns 1 when the writer was initialized; otherwise, 0.
+ */
+int _writer_init(struct json_writer *writer, struct json_sink *sink, const struct json_allocator *allocator);
+
+/**
+ * Makes room in the writer buffer for the given number of characters.
+ *
+ * Buffered characters are handed to the sink, or the buffer is grown.
+ *
+ * @param struct json_writer* writer
+ *   The writer instance.
+ * @param size_t length
+ *   The number of characters to make room for.
+ *
+ * @return int
+ *   Returns 1 when there is room for the characters; otherwise, 0.
+ */
+int _writer_reserve(struct json_writer *writer, size_t length);
+
+/**
+ * Appends characters that may not fit in the writer buffer at once.
+ *
+ * @param struct json_writer* writer
+ *   The writer instance.
+ * @param const char* data
+ *   The characters to append.
+ * @param size_t length
+ *   The number of characters to append.
+ *
+ * @return int
+ *   Returns 1 when the characters were appended; otherwise, 0.
+ */
+int _writer_write_large(struct json_writer *writer, const char *data, size_t length);
+
+/**
+ * Hands the buffered characters to the sink and releases the writer.
+ *
+ * For writers without a sink, the buffer is NUL terminated and kept.
+ *
+ * @param struct json_writer* writer
+ *   The writer instance.
+ *
+ * @return int
+ *   Returns 1 when every character was written; otherwise, 0.
+ */
+int _writer_finish(struct json_writer *writer);
+
+/**
+ * Releases the writer without writing the buffered characters.
+ *
+ * @param struct json_writer* writer
+ *   The writer instance.
+ */
+void _writer_release(struct json_writer *writer);
+
+/**
+ * Appends characters to the writer.
+ *
+ * @param struct json_writer* writer
+ *   The writer instance.
+ * @param const char* data
+ *   The characters to append.
+ * @param size_t length
+ *   The number of characters to append.
+ *
+ * @return int
+ *   Returns 1 when the characters were appended; otherwise, 0.
+ */
+static inline int _writer_write(struct json_writer *writer, const char *data, size_t length) {
+  if (writer->capacity - writer->length < length) {
+    return _writer_write_large(writer, data, length);
+  }
+  memcpy(writer->buffer + writer->length, data, length);
+  writer->length += length;
+  return 1;
+}
+
+/**
+ * Appends a single character to the writer.
+ *
+ * @param struct json_writer* writer
+ *   The writer instance.
+ * @param char character
+ *   The character to append.
+ *
+ * @return int
+ *   Returns 1 when the character was appended; otherwise, 0.
+ */
+static inline int _writer_put(struct json_writer *writer, char character) {
+  if (writer->length == writer->capacity && _writer_reserve(writer, 1) == 0) {
+    return 0;
+  }
+  writer->buffer[writer->length++] = character;
+  return 1;
+}
+
+#endif /* JSON_WRITER_H */
@@ -1,3 +1,5 @@
+#include <locale.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -76,11 +78,12 @@ static int check_json_string(const struct json *json_object, const char *path, c
  *   EXIT_SUCCESS if the value matches the expected, otherwise EXIT_FAILURE.
  */
 static int check_json_double(const struct json *json_object, const char *path, double expected_value) {
-  void *raw_value = get_json_node_value(json_object, path);
-  if (raw_value == NULL) {
+  struct json *node = json_find_node((struct json *)json_object, path, '.');
+  if (node == NULL || node->type != JSON_number) {
+    fprintf(stderr, "Failed to find or decode '%s' in JSON.\n", path);
     return EXIT_FAILURE;
   }
-  double decoded_value = *((double *)raw_value);
+  double decoded_value = json_number_value(node);
   if (decoded_value != expected_value) {
     fprintf(stderr, "Decoded value '%lf' for '%s' does not match expected value '%lf'.\n", decoded_value, path, expected_value);
     return EXIT_FAILURE;
@@ -89,10 +92,7 @@ static int check_json_double(const struct json *json_object, const char *path, d
   return EXIT_SUCCESS;
 }
 
-/**
- * {@inheritdoc}
- */
-int run_json_decode_unit_tests() {
+int run_json_decode_unit_tests_a() {
   // JSON string to be decoded.
   char json_string[] = "{\"employee\":{\"name\":\"John\",\"age\":30,\"city\":\"New York\"}}";
 
@@ -127,3 +127,574 @@ int run_json_decode_unit_tests() {
 
   return EXIT_SUCCESS;
 }
+
+int run_json_decode_unit_tests_b() {
+  // Build a JSON string with 100000 nested arrays: [[[...]]].
+  const int depth = 100000;
+  char *json_string = (char *)malloc(2 * depth + 1);
+  if (json_string == NULL) {
+    return EXIT_FAILURE;
+  }
+  memset(json_string, '[', depth);
+  memset(json_string + depth, ']', depth);
+  json_string[2 * depth] = '\0';
+
+  // The default maximum depth must reject the JSON string.
+  struct json *json_object = json_decode(json_string);
+  if (json_object != NULL) {
+    fprintf(stderr, "Decoded JSON deeper than the default maximum depth.\n");
+    json_destroy(json_object);
+    free(json_string);
+    return EXIT_FAILURE;
+  }
+
+  // A larger maximum depth must decode it without exhausting the C stack.
+  struct json_decode_options options = {.max_depth = depth};
+  json_object = json_decode_with_options(json_string, &options);
+  free(json_string);
+  if (json_object == NULL || json_object->type != JSON_array) {
+    fprintf(stderr, "Failed to decode deeply nested JSON.\n");
+    return EXIT_FAILURE;
+  }
+  printf("Decoded %d nested arrays.\n", depth);
+  json_destroy(json_object);
+
+  return EXIT_SUCCESS;
+}
+
+int run_json_decode_unit_tests_c() {
+  // Build a JSON array with 200000 elements.
+  const int size = 200000;
+  char *json_string = (char *)malloc(2 * size + 2);
+  if (json_string == NULL) {
+    return EXIT_FAILURE;
+  }
+  json_string[0] = '[';
+  for (int i = 0; i < size; ++i) {
+    json_string[1 + 2 * i] = '1';
+    json_string[2 + 2 * i] = ',';
+  }
+  json_string[2 * size] = ']';
+  json_string[2 * size + 1] = '\0';
+
+  // Decode and destroy the long sibling chain.
+  struct json *json_object = json_decode(json_string);
+  free(json_string);
+  if (json_object == NULL || json_object->type != JSON_array) {
+    fprintf(stderr, "Failed to decode large JSON array.\n");
+    return EXIT_FAILURE;
+  }
+  printf("Decoded an array of %d elements.\n", size);
+  json_destroy(json_object);
+
+  // Arrays of objects and empty containers must round trip.
+  char expected[] = "[{\"a\":1,\"b\":[]},{\"c\":{}},true,null]";
+  json_object = json_decode(expected);
+  if (json_object == NULL) {
+    fprintf(stderr, "Failed to decode '%s'.\n", expected);
+    return EXIT_FAILURE;
+  }
+  char *encoded = json_encode(json_object);
+  json_destroy(json_object);
+  if (encoded == NULL || strcmp(encoded, expected) != 0) {
+    fprintf(stderr, "Encoded JSON '%s' does not match expected JSON '%s'.\n", encoded, expected);
+    free(encoded);
+    return EXIT_FAILURE;
+  }
+  printf("Decoded and encoded JSON: %s\n", encoded);
+  free(encoded);
+
+  return EXIT_SUCCESS;
+}
+
+int run_json_decode_unit_tests_d() {
+  // JSON strings of at least 256 characters are decoded through the structural index.
+  char json_string[] =
+    "{ \"text\" : \"a {b} [c], d: \\\"e\\\" \\\\\" ,\n"
+    "  \"list\" : [ 1 , -25 , true , false , null , \"x\" ] ,\n"
+    "  \"padding\" : \"................................................................................................\" ,\n"
+    "  \"nested\" : { \"empty\" : { } , \"items\" : [ [ ] , { \"k\" : \"v\" } ] }\t\r\n"
+    "}";
+  char expected[] =
+    "{\"text\":\"a {b} [c], d: \\\"e\\\" \\\\\","
+    "\"list\":[1,-25,true,false,null,\"x\"],"
+    "\"padding\":\"................................................................................................\","
+    "\"nested\":{\"empty\":{},\"items\":[[],{\"k\":\"v\"}]}}";
+
+  // Decode and encode back the JSON string.
+  struct json *json_object = json_decode(json_string);
+  if (json_object == NULL) {
+    fprintf(stderr, "Failed to decode indexed JSON.\n");
+    return EXIT_FAILURE;
+  }
+  char *encoded = json_encode(json_object);
+  json_destroy(json_object);
+  if (encoded == NULL || strcmp(encoded, expected) != 0) {
+    fprintf(stderr, "Encoded JSON '%s' does not match expected JSON '%s'.\n", encoded, expected);
+    free(encoded);
+    return EXIT_FAILURE;
+  }
+  printf("Decoded and encoded indexed JSON: %s\n", encoded);
+  free(encoded);
+
+  return EXIT_SUCCESS;
+}
+
+int run_json_decode_unit_tests_e() {
+  // Concatenate a large array, an object and a number into a buffer without
+  // any NUL terminator.
+  const size_t count = 3000;
+  const char tail[] = " {\"a\":\"b\"}\n42";
+  const size_t length = 1 + count * 6 + sizeof(tail) - 1;
+  char *buffer = (char *)malloc(length);
+  if (buffer == NULL) {
+    fprintf(stderr, "Failed to allocate the JSON buffer.\n");
+    return EXIT_FAILURE;
+  }
+  size_t position = 0;
+  buffer[position++] = '[';
+  for (size_t i = 0; i < count; i++) {
+    memcpy(buffer + position, i + 1 < count ? "12345," : "12345]", 6);
+    position += 6;
+  }
+  memcpy(buffer + position, tail, sizeof(tail) - 1);
+
+  // Decode the values back to back.
+  const char *expected[] = {NULL, "{\"a\":\"b\"}", "42"};
+  size_t offset = 0;
+  for (int i = 0; i < 3; i++) {
+    size_t consumed = 0;
+    struct json *json_object = json_decode_n(buffer + offset, length - offset, &consumed, NULL);
+    char *encoded = json_encode(json_object);
+    json_destroy(json_object);
+    if (encoded == NULL || (expected[i] != NULL && strcmp(encoded, expected[i]) != 0) || (expected[i] == NULL && strlen(encoded) != 1 + count * 6)) {
+      fprintf(stderr, "Failed to decode JSON value %d of the buffer.\n", i);
+      free(encoded);
+      free(buffer);
+      return EXIT_FAILURE;
+    }
+    printf("Decoded JSON value %d ending at offset %zu.\n", i, offset + consumed);
+    free(encoded);
+    offset += consumed;
+  }
+  free(buffer);
+  if (offset != length) {
+    fprintf(stderr, "Decoding stopped at offset %zu instead of %zu.\n", offset, length);
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int run_json_decode_unit_tests_f() {
+  // 64-bit identifiers are kept exact, while other numbers decode to doubles.
+  const char json_string[] = "{\"id\":9007199254740993,\"min\":-9223372036854775808,\"max\":18446744073709551615,\"ratio\":0.1,\"big\":1e400}";
+  struct json *json_object = json_decode(json_string);
+  if (json_object == NULL) {
+    fprintf(stderr, "Failed to decode JSON string.\n");
+    return EXIT_FAILURE;
+  }
+  const struct json *id = json_find_node(json_object, "id", '.');
+  const struct json *min = json_find_node(json_object, "min", '.');
+  const struct json *max = json_find_node(json_object, "max", '.');
+  int status = json_is_integer(id) && json_integer_value(id) == 9007199254740993LL;
+  status = status && json_is_integer(min) && json_integer_value(min) == INT64_MIN;
+  status = status && json_is_integer(max) && json_unsigned_value(max) == UINT64_MAX && json_integer_value(max) == INT64_MAX;
+  status = status && !json_is_integer(json_find_node(json_object, "ratio", '.')) && check_json_double(json_object, "ratio", 0.1) == EXIT_SUCCESS;
+  // Doubles out of the integer ranges saturate.
+  const struct json *big = json_find_node(json_object, "big", '.');
+  struct json *negative = json_number(-1e300);
+  struct json *above = json_number(1e19);
+  status = status && json_integer_value(big) == INT64_MAX && json_unsigned_value(big) == UINT64_MAX;
+  status = status && json_integer_value(negative) == INT64_MIN && json_unsigned_value(negative) == 0;
+  status = status && json_integer_value(above) == INT64_MAX && json_unsigned_value(above) == 10000000000000000000ULL;
+  json_destroy(negative);
+  json_destroy(above);
+  // Subnormals take the fallback conversion, which ignores the locale decimal point.
+  const char *locales[] = {"C", "de_DE.UTF-8", "fr_FR.UTF-8"};
+  for (size_t i = 0; status && i < sizeof(locales) / sizeof(locales[0]); i++) {
+    if (setlocale(LC_NUMERIC, locales[i]) == NULL) {
+      continue;
+    }
+    struct json *subnormal = json_decode("2.5e-320");
+    status = json_number_value(subnormal) == 2.5e-320;
+    json_destroy(subnormal);
+  }
+  setlocale(LC_NUMERIC, "C");
+  if (!status) {
+    fprintf(stderr, "Decoded integers do not match their exact values.\n");
+    json_destroy(json_object);
+    return EXIT_FAILURE;
+  }
+
+  // The exact integers survive a round trip through the encoder.
+  char *encoded = json_encode(json_object);
+  const char expected[] = "{\"id\":9007199254740993,\"min\":-9223372036854775808,\"max\":18446744073709551615,\"ratio\":0.1,\"big\":null}";
+  status = encoded != NULL && strcmp(encoded, expected) == 0;
+  if (!status) {
+    fprintf(stderr, "Encoded integers '%s' do not match '%s'.\n", encoded != NULL ? encoded : "", expected);
+  } else {
+    printf("Decoded exact 64-bit integers: %s\n", encoded);
+  }
+
+  // Clean up allocated memory.
+  free(encoded);
+  json_destroy(json_object);
+
+  return status ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int run_json_decode_unit_tests_g() {
+  // Escape sequences resolve to UTF-8, including past the first SIMD blocks.
+  const char json_string[] = "{\"text\":\"0123456789abcdef0123456789abcdef caf\\u00e9 \\ud83d\\ude00 \\\"quoted\\\" tab\\t\"}";
+  const char expected[] = "0123456789abcdef0123456789abcdef caf\xc3\xa9 \xf0\x9f\x98\x80 \"quoted\" tab\t";
+  struct json_decode_options strict = {0, JSON_DECODE_STRICT};
+  struct json *json_object = json_decode_with_options(json_string, &strict);
+  int status = json_object != NULL && check_json_string(json_object, "text", expected) == EXIT_SUCCESS;
+  json_destroy(json_object);
+
+  // Strict decoding rejects what lenient decoding lets through.
+  const char *invalid[] = {
+    "[\"bad utf-8 \xc3\x28\"]",
+    "[\"overlong \xc0\xaf\"]",
+    "[\"raw\ttab\"]",
+    "[\"unknown \\q escape\"]",
+    "[\"unpaired \\ud800 surrogate\"]",
+    "{\"key \xff\":1}"
+  };
+  for (size_t i = 0; status && i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+    struct json *lenient = json_decode(invalid[i]);
+    struct json *rejected = json_decode_with_options(invalid[i], &strict);
+    status = lenient != NULL && rejected == NULL;
+    if (!status) {
+      fprintf(stderr, "Strict decoding did not reject invalid string %zu.\n", i);
+    }
+    json_destroy(lenient);
+    json_destroy(rejected);
+  }
+  if (status) {
+    printf("Strict decoding rejected %zu invalid strings.\n", sizeof(invalid) / sizeof(invalid[0]));
+  }
+
+  return status ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int run_json_decode_unit_tests_h() {
+  // Build a large object with a duplicated key, to be searched through its key index.
+  const int size = 10000;
+  char *json_string = (char *)malloc((size_t)size * 24 + 32);
+  if (json_string == NULL) {
+    fprintf(stderr, "Failed to allocate the JSON string.\n");
+    return EXIT_FAILURE;
+  }
+  size_t length = (size_t)sprintf(json_string, "{\"k0\":-1,\"a\\u0000b\":7,");
+  for (int i = 0; i < size; i++) {
+    length += (size_t)sprintf(json_string + length, "\"k%d\":%d,", i, i);
+  }
+  json_string[length - 1] = '}';
+  struct json *json_object = json_decode(json_string);
+  free(json_string);
+  if (json_object == NULL) {
+    fprintf(stderr, "Failed to decode large JSON object.\n");
+    return EXIT_FAILURE;
+  }
+  // Duplicated keys resolve to the first member, as with a linear search.
+  int status = json_integer_value(json_find_node(json_object, "k0", '.')) == -1;
+  char key[32];
+  for (int i = 1; status && i < size; i += 97) {
+    sprintf(key, "k%d", i);
+    status = json_integer_value(json_find_node(json_object, key, '.')) == i;
+  }
+  status = status && json_find_node(json_object, "missing", '.') == NULL;
+  // Keys holding escaped NUL characters are compared over their whole length,
+  // with or without a key index.
+  struct json *small = json_decode("{\"a\\u0000b\":7}");
+  char *small_encoded = json_encode(small);
+  status = status && json_find_node(json_object, "a", '.') == NULL && json_find_node(small, "a", '.') == NULL;
+  status = status && small_encoded != NULL && strcmp(small_encoded, "{\"a\\u0000b\":7}") == 0;
+  free(small_encoded);
+  json_destroy(small);
+  // The index follows pushed and removed members.
+  for (int i = 0; status && i < size; i++) {
+    sprintf(key, "new%d", i);
+    json_push(json_object, json_object_integer(key, i));
+  }
+  status = status && json_integer_value(json_find_node(json_object, "new9999", '.')) == 9999;
+  status = status && json_remove(json_object, "k0") == 1 && json_integer_value(json_find_node(json_object, "k0", '.')) == 0;
+  status = status && json_remove(json_object, "k5000") == 1 && json_find_node(json_object, "k5000", '.') == NULL;
+  status = status && json_remove(json_object, "k5000") == 0;
+  if (!status) {
+    fprintf(stderr, "Indexed lookups in a large JSON object do not match.\n");
+  } else {
+    printf("Looked up keys of a JSON object with %d members.\n", 2 * size - 1);
+  }
+
+  // Clean up allocated memory.
+  json_destroy(json_object);
+
+  return status ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int run_json_decode_unit_tests_i() {
+  // Compiled paths select object members by key and array elements by position.
+  struct json *json_object = json_decode("{\"a\":{\"b\":[10,{\"c\":\"x\"},[1,2]],\"3\":\"three\"}}");
+  if (json_object == NULL) {
+    fprintf(stderr, "Failed to decode JSON string.\n");
+    return EXIT_FAILURE;
+  }
+  struct json_path *member = json_path_compile("a.b.1.c", '.');
+  struct json_path *element = json_path_compile("a.b.2.1", '.');
+  struct json_path *numeric_key = json_path_compile("..a..3..", '.');
+  struct json_path *out_of_range = json_path_compile("a.b.5", '.');
+  struct json_path *key_in_array = json_path_compile("a.b.c", '.');
+  int status = member != NULL && element != NULL && numeric_key != NULL && out_of_range != NULL && key_in_array != NULL;
+  status = status && json_path_compile("..", '.') == NULL;
+  const char *c = status ? json_string_value(json_path_eval(json_object, member)) : NULL;
+  const char *three = status ? json_string_value(json_path_eval(json_object, numeric_key)) : NULL;
+  status = status && c != NULL && strcmp(c, "x") == 0 && three != NULL && strcmp(three, "three") == 0;
+  status = status && json_number_value(json_path_eval(json_object, element)) == 2;
+  status = status && json_path_eval(json_object, out_of_range) == NULL && json_path_eval(json_object, key_in_array) == NULL;
+  if (!status) {
+    fprintf(stderr, "Compiled paths do not find the expected nodes.\n");
+  } else {
+    printf("Compiled path 'a.b.1.c' is: %s\n", c);
+  }
+
+  // Clean up allocated memory.
+  json_path_free(member);
+  json_path_free(element);
+  json_path_free(numeric_key);
+  json_path_free(out_of_range);
+  json_path_free(key_in_array);
+  json_destroy(json_object);
+
+  return status ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int run_json_decode_unit_tests_j() {
+  // Build a long numeric array, to be read by index.
+  const int size = 1000;
+  char *json_string = (char *)malloc((size_t)size * 8 + 8);
+  if (json_string == NULL) {
+    fprintf(stderr, "Failed to allocate the JSON string.\n");
+    return EXIT_FAILURE;
+  }
+  size_t length = (size_t)sprintf(json_string, "[");
+  for (int i = 0; i < size; i++) {
+    length += (size_t)sprintf(json_string + length, "%d,", i * 2);
+  }
+  json_string[length - 1] = ']';
+  struct json *array = json_decode(json_string);
+  struct json_document *document = json_document_create();
+  struct json *document_array = document != NULL ? json_decode_into(document, json_string) : NULL;
+  free(json_string);
+  int status = array != NULL && document_array != NULL && json_array_size(array) == (size_t)size && json_array_size(document_array) == (size_t)size;
+  for (int i = 0; status && i < size; i++) {
+    status = json_integer_value(json_array_get(array, (size_t)i)) == i * 2 && json_integer_value(json_array_get(document_array, (size_t)i)) == i * 2;
+  }
+  status = status && json_array_get(array, (size_t)size) == NULL && json_integer_value(json_find_node_by_index(array, 10)) == 20;
+  // Pushed elements are reachable by index.
+  for (int i = 0; status && i < size; i++) {
+    json_push(array, json_integer(-i));
+  }
+  status = status && json_array_size(array) == (size_t)size * 2 && json_integer_value(json_array_get(array, (size_t)size * 2 - 1)) == 1 - size;
+  if (!status) {
+    fprintf(stderr, "Indexed reads of a JSON array do not match.\n");
+  } else {
+    printf("Read %zu JSON array elements by index.\n", json_array_size(array));
+  }
+
+  // Clean up allocated memory.
+  json_destroy(array);
+  json_document_free(document);
+
+  return status ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int run_json_decode_unit_tests_k() {
+  // Decode a document to a tape, and read it back with the tape iterators.
+  const char *json_string = "{\"name\":\"caf\\u00e9\",\"id\":18446744073709551615,\"ratio\":0.5,\"tags\":[true,null,{},[]],\"nested\":{\"a\":{\"b\":[1,{\"c\":-7}]}}}";
+  size_t offset = 0;
+  struct json_tape *tape = json_tape_decode(json_string, strlen(json_string), &offset, NULL);
+  struct json_path *path = json_path_compile("nested.a.b.1.c", '.');
+  if (tape == NULL || path == NULL) {
+    fprintf(stderr, "Failed to decode JSON string to a tape.\n");
+    json_tape_free(tape);
+    json_path_free(path);
+    return EXIT_FAILURE;
+  }
+  struct json_tape_value root = json_tape_root(tape);
+  struct json_tape_value value;
+  int status = offset == strlen(json_string) && json_tape_type(root) == JSON_object;
+  status = status && json_tape_find(root, "name", '.', &value) && strcmp(json_tape_string(value, NULL), "caf\xc3\xa9") == 0;
+  status = status && json_tape_find(root, "id", '.', &value) && json_tape_integer(value) == INT64_MAX;
+  status = status && json_tape_find(root, "ratio", '.', &value) && json_tape_number(value) == 0.5;
+  status = status && json_tape_find(root, "tags.0", '.', &value) && json_tape_bool(value) == 1;
+  status = status && json_tape_find(root, "..nested..a.b.1.c", '.', &value) && json_tape_integer(value) == -7;
+  status = status && json_tape_path_eval(root, path, &value) && json_tape_integer(value) == -7;
+  status = status && !json_tape_find(root, "tags.4", '.', &value) && !json_tape_find(root, "nested.b", '.', &value);
+  // Doubles out of range saturate, and other values read as 0.
+  struct json_tape *huge = json_tape_decode("-1e300", 6, NULL, NULL);
+  struct json_tape *literal = json_tape_decode("true", 4, NULL, NULL);
+  status = status && huge != NULL && json_tape_integer(json_tape_root(huge)) == INT64_MIN;
+  status = status && literal != NULL && json_tape_number(json_tape_root(literal)) == 0 && json_tape_integer(json_tape_root(literal)) == 0;
+  json_tape_free(huge);
+  json_tape_free(literal);
+  // Siblings are reached past nested containers, in document order.
+  int members = 0;
+  const char *key = NULL;
+  for (int found = json_tape_first(root, &value); status && found; found = json_tape_next(&value)) {
+    key = json_tape_key(value, NULL);
+    members++;
+  }
+  status = status && members == 5 && key != NULL && strcmp(key, "nested") == 0;
+  int elements = 0;
+  status = status && json_tape_find(root, "tags", '.', &value) && json_tape_type(value) == JSON_array;
+  for (int found = status && json_tape_first(value, &value); found; found = json_tape_next(&value)) {
+    status = status && json_tape_key(value, NULL) == NULL;
+    elements++;
+  }
+  status = status && elements == 4 && json_tape_find(root, "tags.2", '.', &value) && !json_tape_first(value, &value);
+  status = status && json_tape_decode("[1,", 3, NULL, NULL) == NULL;
+  if (!status) {
+    fprintf(stderr, "Tape reads do not match the decoded JSON.\n");
+  } else {
+    printf("Decoded a JSON tape of %zu bytes.\n", json_tape_memory(tape));
+  }
+
+  // Clean up allocated memory.
+  json_path_free(path);
+  json_tape_free(tape);
+
+  return status ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * The data struct definition for the state of a concurrent lookup thread.
+ */
+struct decode_lookup_context {
+  struct json *object;
+  int first;
+  int found;
+};
+
+/**
+ * Looks up the keys of a shared JSON object, from a reader thread.
+ *
+ * @param void* argument
+ *   The lookup thread state.
+ *
+ * @return void*
+ *   Always NULL.
+ */
+static void *decode_lookup_thread(void *argument) {
+  struct decode_lookup_context *context = (struct decode_lookup_context *)argument;
+  char path[48];
+  char expected[16];
+  for (int i = 0; i < 200; i++) {
+    const int key = (context->first + i * 7) % 200;
+    sprintf(path, "items.k%d..v", key);
+    int found = json_integer_value(json_find_node(context->object, path, '.')) == key * 3;
+    // Escaped string views are materialized by the first reader.
+    sprintf(path, "items.k%d..s", key);
+    sprintf(expected, "\"%d", key);
+    const char *text = json_string_value(json_find_node(context->object, path, '.'));
+    context->found += found && text != NULL && strcmp(text, expected) == 0;
+  }
+  return NULL;
+}
+
+int run_json_decode_unit_tests_l() {
+  // Build an object large enough to be indexed on its first lookup.
+  const int size = 200;
+  char *json_string = (char *)malloc((size_t)size * 48 + 16);
+  if (json_string == NULL) {
+    fprintf(stderr, "Failed to allocate the JSON string.\n");
+    return EXIT_FAILURE;
+  }
+  size_t length = (size_t)sprintf(json_string, "{\"items\":{");
+  for (int i = 0; i < size; i++) {
+    length += (size_t)sprintf(json_string + length, "\"k%d\":{\"v\":%d,\"s\":\"\\\"%d\"},", i, i * 3, i);
+  }
+  sprintf(json_string + length - 1, "}}");
+  // Keep the strings as views into the input, materialized when read.
+  const struct json_decode_options options = {0, JSON_DECODE_ZERO_COPY};
+  struct json *lazy = json_decode_with_options(json_string, &options);
+  struct json *prepared = json_decode_with_options(json_string, &options);
+  int status = lazy != NULL && prepared != NULL && json_build_indexes(prepared) == 1;
+  // Look up both trees from several threads at once.
+  enum { THREADS = 8 };
+  pthread_t threads[THREADS * 2];
+  struct decode_lookup_context contexts[THREADS * 2];
+  int started = 0;
+  for (int i = 0; status && i < THREADS * 2; i++) {
+    contexts[i].object = i < THREADS ? lazy : prepared;
+    contexts[i].first = i * 13;
+    contexts[i].found = 0;
+    if (pthread_create(&threads[i], NULL, decode_lookup_thread, &contexts[i]) != 0) {
+      status = 0;
+      break;
+    }
+    started++;
+  }
+  for (int i = 0; i < started; i++) {
+    pthread_join(threads[i], NULL);
+    status = status && contexts[i].found == size;
+  }
+  status = status && json_find_node(lazy, "..", '.') == NULL && json_find_node(lazy, "items.k1.w", '.') == NULL;
+  if (!status) {
+    fprintf(stderr, "Concurrent lookups in a shared JSON object do not match.\n");
+  } else {
+    printf("Looked up %d keys from %d threads at once.\n", started * size, started);
+  }
+
+  // Clean up allocated memory.
+  json_destroy(lazy);
+  json_destroy(prepared);
+  free(json_string);
+
+  return status ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int run_json_decode_unit_tests() {
+  if (run_json_decode_unit_tests_a() == EXIT_FAILURE) {
+    return EXIT_FAILURE;
+  }
+  if (run_json_decode_unit_tests_b() == EXIT_FAILURE) {
+    return EXIT_FAILURE;
+  }
+  if (run_json_decode_unit_tests_c() == EXIT_FAILURE) {
+    return EXIT_FAILURE;
+  }
+  if (run_json_decode_unit_tests_d() == EXIT_FAILURE) {
+    return EXIT_FAILURE;
+  }
+  if (run_json_decode_unit_tests_e() == EXIT_FAILURE) {
+    return EXIT_FAILURE;
+  }
+  if (run_json_decode_unit_tests_f() == EXIT_FAILURE) {
+    return EXIT_FAILURE;
+  }
+  if (run_json_decode_unit_tests_g() == EXIT_FAILURE) {
+    return EXIT_FAILURE;
+  }
+  if (run_json_decode_unit_tests_h() == EXIT_FAILURE) {
+    return EXIT_FAILURE;
+  }
+  if (run_json_decode_unit_tests_i() == EXIT_FAILURE) {
+    return EXIT_FAILURE;
+  }
+  if (run_json_decode_unit_tests_j() == EXIT_FAILURE) {
+    return EXIT_FAILURE;
+  }
+  if (run_json_decode_unit_tests_k() == EXIT_FAILURE) {
+    return EXIT_FAILURE;
+  }
+  if (run_json_decode_unit_tests_l() == EXIT_FAILURE) {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,226 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <filehelper.h>
+#include "../include/json.h"
+#include "json_document_unit_tests.h"
+
+/**
+ * Helper function to decode a JSON string into a document and check one string value.
+ *
+ * @param struct json_document *document
+ *   The JSON document that owns the decoded JSON object.
+ * @param const char *json_string
+ *   The JSON string to decode.
+ * @param const char *path
+ *   The path to the JSON node containing the string value.
+ * @param const char *expected_value
+ *   The expected string value of the JSON node.
+ *
+ * @return int
+ *   EXIT_SUCCESS if the value matches the expected, otherwise EXIT_FAILURE.
+ */
+static int check_document_string(struct json_document *document, const char *json_string, const char *path, const char *expected_value) {
+  struct json *json_object = json_decode_into(document, json_string);
+  if (json_object == NULL || json_object != json_document_root(document)) {
+    fprintf(stderr, "Failed to decode JSON into document.\n");
+    return EXIT_FAILURE;
+  }
+  struct json *node = json_find_node(json_object, path, '.');
+  if (node == NULL || node->value == NULL || strcmp((const char *)node->value, expected_value) != 0) {
+    fprintf(stderr, "Document value for '%s' does not match expected value '%s'.\n", path, expected_value);
+    return EXIT_FAILURE;
+  }
+  printf("Document value '%s' is: %s\n", path, (const char *)node->value);
+  return EXIT_SUCCESS;
+}
+
+/**
+ * The number of live allocations made through the counting allocator.
+ */
+struct counting_allocator {
+  size_t live;
+  size_t total;
+};
+
+/**
+ * Allocates memory, counting the allocation.
+ */
+static void *counting_alloc(void *context, size_t size) {
+  struct counting_allocator *counter = (struct counting_allocator *)context;
+  void *pointer = malloc(size);
+  if (pointer != NULL) {
+    counter->live++;
+    counter->total++;
+  }
+  return pointer;
+}
+
+/**
+ * Resizes memory, counting the allocation when there was none.
+ */
+static void *counting_realloc(void *context, void *pointer, size_t size) {
+  struct counting_allocator *counter = (struct counting_allocator *)context;
+  void *resized = realloc(pointer, size);
+  if (resized != NULL && pointer == NULL) {
+    counter->live++;
+    counter->total++;
+  }
+  return resized;
+}
+
+/**
+ * Releases memory, counting the release.
+ */
+static void counting_free(void *context, void *pointer) {
+  struct counting_allocator *counter = (struct counting_allocator *)context;
+  if (pointer != NULL) {
+    counter->live--;
+  }
+  free(pointer);
+}
+
+/**
+ * {@inheritdoc}
+ */
+int run_json_document_unit_tests() {
+  struct json_document *document = json_document_create();
+  if (document == NULL) {
+    fprintf(stderr, "Failed to create JSON document.\n");
+    return EXIT_FAILURE;
+  }
+
+  // Decode a nested object.
+  char json_string[] = "{\"employee\":{\"name\":\"John\",\"age\":30,\"active\":true,\"tags\":[\"a\",null]}}";
+  if (check_document_string(document, json_string, "employee.name", "John") == EXIT_FAILURE) {
+    json_document_free(document);
+    return EXIT_FAILURE;
+  }
+  void *age = json_get_number(json_document_root(document), "employee.age");
+  if (age == NULL || json_value_to_double(age) != 30.0) {
+    fprintf(stderr, "Document value for 'employee.age' does not match expected value '30'.\n");
+    json_document_free(document);
+    return EXIT_FAILURE;
+  }
+
+  struct json *active = json_find_node(json_document_root(document), "employee.active", '.');
+  if (json_bool_value(active) != 1) {
+    fprintf(stderr, "Document value for 'employee.active' does not match expected value 'true'.\n");
+    json_document_free(document);
+    return EXIT_FAILURE;
+  }
+
+  // Reuse the document memory for another JSON string.
+  json_document_reset(document);
+  if (check_document_string(document, "{\"city\":\"New York\"}", "city", "New York") == EXIT_FAILURE) {
+    json_document_free(document);
+    return EXIT_FAILURE;
+  }
+
+  // Decode with zero-copy views into the input string.
+  struct json_decode_options options = { 0, JSON_DECODE_ZERO_COPY };
+  json_document_set_options(document, &options);
+  json_document_reset(document);
+  const char *view_string = "{\"name\":\"Jane\",\"quote\":\"say \\\"hi\\\"\"}";
+  struct json *view_root = json_decode_into(document, view_string);
+  size_t length = 0;
+  const char *name = json_string_view(json_find_node(view_root, "name", '.'), &length);
+  if (name < view_string || name >= view_string + strlen(view_string) || length != 4 || strncmp(name, "Jane", length) != 0) {
+    fprintf(stderr, "Document view for 'name' does not point into the input string.\n");
+    json_document_free(document);
+    return EXIT_FAILURE;
+  }
+  const char *quote = json_string_value(json_find_node(view_root, "quote", '.'));
+  char *encoded = json_encode(view_root);
+  // The length may be left out.
+  if (quote == NULL || json_string_view(json_find_node(view_root, "quote", '.'), NULL) != quote || encoded == NULL || strcmp(encoded, view_string) != 0) {
+    fprintf(stderr, "Document views do not round trip the input string.\n");
+    free(encoded);
+    json_document_free(document);
+    return EXIT_FAILURE;
+  }
+  printf("Document view 'quote' is: %s\n", quote);
+  free(encoded);
+
+  // Decode a memory mapped file, keeping the views into the mapping.
+  char filepath[] = "/tmp/json_document_unit_tests_XXXXXX";
+  int fd = mkstemp(filepath);
+  if (fd < 0 || file_put_contents(filepath, "{\"file\":{\"name\":\"catalog.json\"}}") == 0) {
+    fprintf(stderr, "Failed to write the JSON file.\n");
+    json_document_free(document);
+    return EXIT_FAILURE;
+  }
+  close(fd);
+  struct json *file_root = json_document_open(document, filepath);
+  unlink(filepath);
+  const char *file_name = json_string_view(json_find_node(file_root, "file.name", '.'), &length);
+  if (file_name == NULL || length != 12 || strncmp(file_name, "catalog.json", length) != 0) {
+    fprintf(stderr, "Document value for 'file.name' does not match expected value 'catalog.json'.\n");
+    json_document_free(document);
+    return EXIT_FAILURE;
+  }
+  printf("Document value 'file.name' is: %.*s\n", (int)length, file_name);
+
+  // Look the members of a large object up through the index built when decoded.
+  char members[1024] = "{";
+  for (int i = 0; i < 40; i++) {
+    snprintf(members + strlen(members), sizeof(members) - strlen(members), "\"k%d\":%d,", i, i);
+  }
+  strcat(members, "\"k7\":\"duplicate\"}");
+  json_document_reset(document);
+  struct json *members_root = json_decode_into(document, members);
+  int indexed = members_root != NULL && json_build_indexes(members_root) == 1;
+  for (int i = 0; indexed && i < 40; i++) {
+    char key[16];
+    snprintf(key, sizeof(key), "k%d", i);
+    indexed = json_integer_value(json_find_node(members_root, key, '.')) == i;
+  }
+  if (!indexed || json_find_node(members_root, "k40", '.') != NULL) {
+    fprintf(stderr, "Failed to look the members of a large document object up.\n");
+    json_document_free(document);
+    return EXIT_FAILURE;
+  }
+  printf("Looked 40 document members up through their index.\n");
+
+  // Release every decoded JSON object at once.
+  json_document_free(document);
+
+  // Documents, encoded strings and trees honor the given allocators.
+  struct counting_allocator counter = {0, 0};
+  const struct json_allocator allocator = {counting_alloc, counting_realloc, counting_free, &counter};
+  const struct json_encode_options encode_options = {0, 0, &allocator};
+  document = json_document_create_with_allocator(&allocator);
+  char *document_encoded = json_encode_with_options(json_decode_into(document, "{\"items\":[1,2,3,4,5,6,7,8,9]}"), &encode_options);
+  int status = document_encoded != NULL && strcmp(document_encoded, "{\"items\":[1,2,3,4,5,6,7,8,9]}") == 0;
+  counting_free(&counter, document_encoded);
+  json_document_free(document);
+  status = status && counter.total >= 3 && counter.live == 0;
+  // Decoding calls allocate their temporary buffers with the allocator of the options.
+  const struct json_decode_options decode_options = {0, 0, &allocator};
+  const size_t decode_allocations = counter.total;
+  struct json *nested = json_decode_with_options("[[[[true]]]]", &decode_options);
+  status = status && json_bool_value(json_find_node_by_index(json_find_node_by_index(json_find_node_by_index(json_find_node_by_index(nested, 0), 0), 0), 0)) == 1;
+  json_destroy(nested);
+  status = status && counter.total > decode_allocations && counter.live == 0;
+  // Allocators missing a callback are rejected.
+  const struct json_allocator incomplete = {counting_alloc, NULL, counting_free, &counter};
+  status = status && json_document_create_with_allocator(&incomplete) == NULL;
+  const size_t document_allocations = counter.total;
+  status = status && json_set_allocator(&allocator) == 1;
+  struct json *tree = json_object("tree", NULL);
+  json_push(tree, json_object_string("name", "a string longer than the inline storage"));
+  char *tree_encoded = json_encode(tree);
+  status = status && tree_encoded != NULL && counter.live > 0;
+  json_free(tree_encoded);
+  json_destroy(tree);
+  json_pool_trim();
+  status = status && json_set_allocator(NULL) == 1 && counter.live == 0 && counter.total > document_allocations;
+  if (!status) {
+    fprintf(stderr, "Allocations do not go through the given allocators.\n");
+    return EXIT_FAILURE;
+  }
+  printf("Made %zu allocations through a custom allocator.\n", counter.total);
+
+  return EXIT_SUCCESS;
+}
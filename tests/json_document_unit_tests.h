@@ -0,0 +1,15 @@
+#ifndef JSON_DOCUMENT_UNIT_TESTS_H
+#define JSON_DOCUMENT_UNIT_TESTS_H
+
+/**
+ * Runs the JSON document unit tests.
+ *
+ * This function decodes JSON strings into an arena-backed JSON document, checks the
+ * decoded values, resets the document to decode another string and finally frees it.
+ *
+ * @return int
+ *   EXIT_SUCCESS if all tests pass, otherwise EXIT_FAILURE.
+ */
+int run_json_document_unit_tests();
+
+#endif
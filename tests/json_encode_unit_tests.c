@@ -1,3 +1,4 @@
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -196,6 +197,300 @@ int run_json_encode_unit_tests_e() {
   return result;
 }
 
+/**
+ * Sink callback appending the encoded characters to a string, one batch at a time.
+ */
+static int append_batch(void *context, const char *data, size_t length) {
+  char *string = (char *)context;
+  size_t offset = strlen(string);
+  memcpy(string + offset, data, length);
+  string[offset + length] = '\0';
+  return length <= 65536;
+}
+
+int run_json_encode_unit_tests_f() {
+  // Create a JSON array larger than the encoder batch buffer.
+  struct json *array = json_array();
+  for (int i = 0; i < 20000; i++) {
+    json_push(array, json_number(i));
+  }
+  char *expected_json_string = json_encode(array);
+  size_t length = expected_json_string != NULL ? strlen(expected_json_string) : 0;
+  char *streamed = (char *)calloc(length + 1, 1);
+  if (expected_json_string == NULL || streamed == NULL || length <= 65536) {
+    fprintf(stderr, "Failed to encode JSON array.\n");
+    free(expected_json_string);
+    free(streamed);
+    json_destroy(array);
+    return EXIT_FAILURE;
+  }
+
+  // Stream the array to a callback, then to a fixed buffer that fits exactly.
+  struct json_sink callback_sink = json_sink_callback(append_batch, streamed);
+  int status = json_encode_to(array, &callback_sink) == 1 && callback_sink.length == length && strcmp(streamed, expected_json_string) == 0;
+  memset(streamed, 0, length + 1);
+  struct json_sink buffer_sink = json_sink_buffer(streamed, length);
+  status = status && json_encode_to(array, &buffer_sink) == 1 && buffer_sink.length == length && memcmp(streamed, expected_json_string, length) == 0;
+  // A fixed buffer that is too small is rejected.
+  buffer_sink = json_sink_buffer(streamed, length - 1);
+  status = status && json_encode_to(array, &buffer_sink) == 0;
+  if (!status) {
+    fprintf(stderr, "Streamed JSON does not match the encoded JSON string.\n");
+  } else {
+    printf("Streamed %zu characters of JSON to callback and buffer sinks.\n", length);
+  }
+
+  // Clean up allocated memory.
+  free(expected_json_string);
+  free(streamed);
+  json_destroy(array);
+
+  return status ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int run_json_encode_unit_tests_g() {
+  // Numbers are encoded with the fewest digits that read back to the same value.
+  struct json *array = json_array();
+  if (array == NULL) {
+    fprintf(stderr, "Failed to create JSON array.\n");
+    return EXIT_FAILURE;
+  }
+  double numbers[] = {0, -0.0, 30, -42, 0.1, 0.3, 3.14159, 1e21, 1e-7, 0.000001234, 9007199254740993.0, 5e-324, 1.7976931348623157e308};
+  for (size_t i = 0; i < sizeof(numbers) / sizeof(numbers[0]); i++) {
+    json_push(array, json_number(numbers[i]));
+  }
+  json_push(array, json_number_string(2.5));
+  char expected[] = "[0,-0,30,-42,0.1,0.3,3.14159,1e+21,1e-7,0.000001234,9007199254740992,5e-324,1.7976931348623157e+308,\"2.5\"]";
+  char *encoded = json_encode(array);
+  if (encoded == NULL) {
+    fprintf(stderr, "Failed to encode JSON array.\n");
+    json_destroy(array);
+    return EXIT_FAILURE;
+  }
+
+  // Compare the encoded numbers with the expected shortest representations.
+  int result = run_json_encode_compare(expected, encoded);
+
+  // Clean up allocated memory.
+  free(encoded);
+  json_destroy(array);
+
+  return result;
+}
+
+int run_json_encode_unit_tests_h() {
+  // Keys and values are escaped, wherever the characters to escape appear in long runs.
+  struct json *object = json_empty_object();
+  if (object == NULL) {
+    fprintf(stderr, "Failed to create JSON object.\n");
+    return EXIT_FAILURE;
+  }
+  json_push(object, json_object_string("say \"hi\"", "tab\there"));
+  json_push(object, json_object_string("path", "C:\\Program Files\\LibJSON\\include\\json.h\n\x01"));
+  json_push(object, json_object_string("plain", "caf\xc3\xa9 au lait, no escaping needed in this long value"));
+  char expected[] = "{\"say \\\"hi\\\"\":\"tab\\there\",\"path\":\"C:\\\\Program Files\\\\LibJSON\\\\include\\\\json.h\\n\\u0001\",\"plain\":\"caf\xc3\xa9 au lait, no escaping needed in this long value\"}";
+  char *encoded = json_encode(object);
+  int result = encoded != NULL ? run_json_encode_compare(expected, encoded) : EXIT_FAILURE;
+
+  // Decoding the encoded string gives back the original characters.
+  struct json *decoded = encoded != NULL ? json_decode(encoded) : NULL;
+  char *reencoded = json_encode(decoded);
+  if (result == EXIT_SUCCESS && (reencoded == NULL || strcmp(reencoded, expected) != 0 ||
+      strcmp(json_string_value(json_find_node(decoded, "say \"hi\"", '.')), "tab\there") != 0)) {
+    fprintf(stderr, "Escaped JSON string does not survive a round trip.\n");
+    result = EXIT_FAILURE;
+  }
+
+  // Clean up allocated memory.
+  free(encoded);
+  free(reencoded);
+  json_destroy(decoded);
+  json_destroy(object);
+
+  return result;
+}
+
+int run_json_encode_unit_tests_i() {
+  // Measure the encoded size, then encode with a single allocation or none at all.
+  struct json *employee = json_object("employee", NULL);
+  if (employee == NULL) {
+    fprintf(stderr, "Failed to create JSON object.\n");
+    return EXIT_FAILURE;
+  }
+  json_push(employee, json_object_string("name", "John \"Johnny\" Doe"));
+  json_push(employee, json_object_integer("id", 9007199254740993LL));
+  json_push(employee, json_object_number("rate", 0.1));
+  char expected[] = "{\"employee\":{\"name\":\"John \\\"Johnny\\\" Doe\",\"id\":9007199254740993,\"rate\":0.1}}";
+  const size_t size = json_encoded_size(employee);
+  char *encoded = json_encode_exact(employee);
+  char buffer[128];
+  int status = size == strlen(expected) && encoded != NULL && strcmp(encoded, expected) == 0;
+  status = status && json_encode_into(employee, buffer, sizeof(buffer)) == size && strcmp(buffer, expected) == 0;
+  // Buffers too small are rejected.
+  status = status && json_encode_into(employee, buffer, size - 1) == 0;
+  if (!status) {
+    fprintf(stderr, "Exact-size encoding does not match the expected JSON string.\n");
+  } else {
+    printf("Measured and encoded %zu characters of JSON exactly.\n", size);
+  }
+
+  // Clean up allocated memory.
+  free(encoded);
+  json_destroy(employee);
+
+  return status ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int run_json_encode_unit_tests_j() {
+  // Pretty-print with indentation, sorted keys and compact scalar arrays.
+  struct json *object = json_decode("{\"name\":\"John\",\"age\":30,\"tags\":[1,2,3],\"address\":{\"zip\":\"10001\",\"city\":\"NY\"},\"items\":[{\"b\":true,\"a\":null}],\"empty\":{},\"none\":[]}");
+  if (object == NULL) {
+    fprintf(stderr, "Failed to decode JSON string.\n");
+    return EXIT_FAILURE;
+  }
+  const struct json_encode_options pretty = {2, JSON_ENCODE_SORT_KEYS | JSON_ENCODE_COMPACT_ARRAYS};
+  const struct json_encode_options sorted = {0, JSON_ENCODE_SORT_KEYS};
+  char expected_pretty[] =
+    "{\n"
+    "  \"address\": {\n"
+    "    \"city\": \"NY\",\n"
+    "    \"zip\": \"10001\"\n"
+    "  },\n"
+    "  \"age\": 30,\n"
+    "  \"empty\": {},\n"
+    "  \"items\": [\n"
+    "    {\n"
+    "      \"a\": null,\n"
+    "      \"b\": true\n"
+    "    }\n"
+    "  ],\n"
+    "  \"name\": \"John\",\n"
+    "  \"none\": [],\n"
+    "  \"tags\": [1, 2, 3]\n"
+    "}";
+  char expected_sorted[] = "{\"address\":{\"city\":\"NY\",\"zip\":\"10001\"},\"age\":30,\"empty\":{},\"items\":[{\"a\":null,\"b\":true}],\"name\":\"John\",\"none\":[],\"tags\":[1,2,3]}";
+  char *encoded_pretty = json_encode_with_options(object, &pretty);
+  char *encoded_sorted = json_encode_with_options(object, &sorted);
+  int status = encoded_pretty != NULL && strcmp(encoded_pretty, expected_pretty) == 0;
+  status = status && encoded_sorted != NULL && strcmp(encoded_sorted, expected_sorted) == 0;
+  // Pretty output decodes back to the same JSON object.
+  struct json *decoded = status ? json_decode(encoded_pretty) : NULL;
+  char *encoded = decoded != NULL ? json_encode_with_options(decoded, &sorted) : NULL;
+  status = status && encoded != NULL && strcmp(encoded, expected_sorted) == 0;
+  if (!status) {
+    fprintf(stderr, "Pretty-printed JSON '%s' does not match the expected JSON string.\n", encoded_pretty != NULL ? encoded_pretty : "");
+  } else {
+    printf("Pretty-printed JSON:\n%s\n", encoded_pretty);
+  }
+
+  // Clean up allocated memory.
+  free(encoded_pretty);
+  free(encoded_sorted);
+  free(encoded);
+  json_destroy(decoded);
+  json_destroy(object);
+
+  return status ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int run_json_encode_unit_tests_k() {
+  // Appending to containers takes constant time, so large builds stay linear.
+  const size_t size = 100000;
+  struct json *rows = json_array();
+  if (rows == NULL) {
+    fprintf(stderr, "Failed to create JSON array.\n");
+    return EXIT_FAILURE;
+  }
+  for (size_t i = 0; i < size; i++) {
+    json_push(rows, json_integer((int64_t)i));
+  }
+  struct json *batch[] = {json_bool(1), json_null(), json_string("last")};
+  int status = json_push_multiple(rows, batch, 3) == 0 && json_array_size(rows) == size + 3;
+  status = status && json_integer_value(json_array_get(rows, size - 1)) == (int64_t)size - 1;
+  status = status && strcmp(json_string_value(json_array_get(rows, size + 2)), "last") == 0;
+  json_destroy(rows);
+
+  // Chains given up front are extended after their last node.
+  struct json *object = json_object("employee", json_object_string("name", "John"));
+  struct json *members[] = {json_object_integer("age", 30), json_object_string("city", "New York")};
+  char expected[] = "{\"employee\":{\"name\":\"John\",\"age\":30,\"city\":\"New York\",\"active\":true}}";
+  status = status && object != NULL && json_push_multiple(object, members, 2) == 0;
+  if (status) {
+    json_push(object, json_object("active", json_bool(1)));
+  }
+  char *encoded = status ? json_encode(object) : NULL;
+  status = status && encoded != NULL && strcmp(encoded, expected) == 0;
+  if (!status) {
+    fprintf(stderr, "Appended JSON values do not match the expected JSON string.\n");
+  } else {
+    printf("Appended %zu JSON values in constant time each.\n", size + 3);
+  }
+
+  // Clean up allocated memory.
+  free(encoded);
+  json_destroy(object);
+
+  return status ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * Builds, encodes and destroys JSON responses over and over, from a builder thread.
+ *
+ * @param void* argument
+ *   Receives 1 when every response matched; otherwise, 0.
+ *
+ * @return void*
+ *   Always NULL.
+ */
+static void *run_json_encode_builder_thread(void *argument) {
+  int *status = (int *)argument;
+  const char expected[] = "{\"response\":{\"id\":7,\"message\":\"a message longer than the inline storage\",\"tags\":[\"x\",null]}}";
+  *status = 1;
+  for (int i = 0; *status && i < 2000; i++) {
+    struct json *response = json_object("response", NULL);
+    struct json *tags = json_array();
+    json_push(tags, json_string("x"));
+    json_push(tags, json_null());
+    json_push(response, json_object_integer("id", 7));
+    json_push(response, json_object_string("message", "a message longer than the inline storage"));
+    json_push(response, json_object("tags", tags));
+    char *encoded = i % 100 == 0 ? json_encode(response) : NULL;
+    *status = i % 100 != 0 || (encoded != NULL && strcmp(encoded, expected) == 0);
+    free(encoded);
+    json_destroy(response);
+  }
+  return NULL;
+}
+
+int run_json_encode_unit_tests_l() {
+  // Build and destroy short-lived trees from several threads at once.
+  enum { THREADS = 8 };
+  pthread_t threads[THREADS];
+  int statuses[THREADS];
+  int started = 0;
+  int status = 1;
+  for (int i = 0; i < THREADS; i++) {
+    if (pthread_create(&threads[i], NULL, run_json_encode_builder_thread, &statuses[i]) != 0) {
+      status = 0;
+      break;
+    }
+    started++;
+  }
+  for (int i = 0; i < started; i++) {
+    pthread_join(threads[i], NULL);
+    status = status && statuses[i] == 1;
+  }
+  // Destroyed nodes are cached by the destroying thread until trimmed.
+  run_json_encode_builder_thread(&statuses[0]);
+  status = status && statuses[0] == 1 && json_pool_trim() > 0 && json_pool_trim() == 0;
+  if (!status) {
+    fprintf(stderr, "JSON trees built from several threads do not match.\n");
+  } else {
+    printf("Built and destroyed %d JSON trees from %d threads.\n", (started + 1) * 2000, started + 1);
+  }
+  return status ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 /**
  * {@inheritdoc}
  */
@@ -215,5 +510,26 @@ int run_json_encode_unit_tests() {
   if (run_json_encode_unit_tests_e() == EXIT_FAILURE) {
     return EXIT_FAILURE;
   }
+  if (run_json_encode_unit_tests_f() == EXIT_FAILURE) {
+    return EXIT_FAILURE;
+  }
+  if (run_json_encode_unit_tests_g() == EXIT_FAILURE) {
+    return EXIT_FAILURE;
+  }
+  if (run_json_encode_unit_tests_h() == EXIT_FAILURE) {
+    return EXIT_FAILURE;
+  }
+  if (run_json_encode_unit_tests_i() == EXIT_FAILURE) {
+    return EXIT_FAILURE;
+  }
+  if (run_json_encode_unit_tests_j() == EXIT_FAILURE) {
+    return EXIT_FAILURE;
+  }
+  if (run_json_encode_unit_tests_k() == EXIT_FAILURE) {
+    return EXIT_FAILURE;
+  }
+  if (run_json_encode_unit_tests_l() == EXIT_FAILURE) {
+    return EXIT_FAILURE;
+  }
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,84 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/json.h"
+#include "json_lines_unit_tests.h"
+
+/**
+ * The state of the test callback.
+ */
+struct lines_test_context {
+  size_t records;
+  size_t invalid;
+  size_t next_line;
+  int ordered;
+};
+
+/**
+ * Checks that the records are reported in input order.
+ *
+ * @param void* context
+ *   The test state.
+ * @param size_t line
+ *   The line number of the record.
+ * @param struct json* record
+ *   The decoded record.
+ *
+ * @return int
+ *   Always 1.
+ */
+static int on_record(void *context, size_t line, struct json *record) {
+  struct lines_test_context *state = (struct lines_test_context *)context;
+  if (line < state->next_line) {
+    state->ordered = 0;
+  }
+  state->next_line = line + 1;
+  if (record == NULL) {
+    state->invalid++;
+    return 1;
+  }
+  // Every record holds its own line number.
+  void *id = json_get_number(record, "id");
+  if (id == NULL || json_value_to_double(id) != (double)line) {
+    state->ordered = 0;
+  }
+  state->records++;
+  return 1;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int run_json_lines_unit_tests() {
+  // Build about 4 MB of records, with a blank line and an invalid line.
+  const size_t count = 100000;
+  size_t capacity = count * 48;
+  char *buffer = (char *)malloc(capacity);
+  if (buffer == NULL) {
+    fprintf(stderr, "Failed to allocate the JSON Lines buffer.\n");
+    return EXIT_FAILURE;
+  }
+  size_t length = 0;
+  for (size_t line = 0; line < count; line++) {
+    if (line == 10) {
+      length += (size_t)snprintf(buffer + length, capacity - length, "  \r\n");
+    } else if (line == 20) {
+      length += (size_t)snprintf(buffer + length, capacity - length, "{\"id\":20} {}\n");
+    } else {
+      length += (size_t)snprintf(buffer + length, capacity - length, "{\"id\":%zu,\"name\":\"record\",\"tags\":[1,2]}\n", line);
+    }
+  }
+
+  // Decode the records with several threads.
+  struct lines_test_context context = {0, 0, 0, 1};
+  struct json_lines_options options = {4, {0, 0}};
+  int status = json_decode_lines(buffer, length, &options, on_record, &context);
+  free(buffer);
+  if (status == 0 || context.ordered == 0 || context.records != count - 2 || context.invalid != 1) {
+    fprintf(stderr, "Decoded %zu records and %zu invalid lines instead of %zu and 1.\n", context.records, context.invalid, count - 2);
+    return EXIT_FAILURE;
+  }
+  printf("Decoded %zu records and %zu invalid line in input order.\n", context.records, context.invalid);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,16 @@
+#ifndef JSON_LINES_UNIT_TESTS_H
+#define JSON_LINES_UNIT_TESTS_H
+
+/**
+ * Runs the JSON Lines unit tests.
+ *
+ * This function decodes a large buffer of newline-delimited JSON records with several
+ * threads, and checks that every record is reported once, in input order, with invalid
+ * lines reported as NULL.
+ *
+ * @return int
+ *   EXIT_SUCCESS if all tests pass, otherwise EXIT_FAILURE.
+ */
+int run_json_lines_unit_tests();
+
+#endif
@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/json.h"
+#include "json_parser_unit_tests.h"
+
+/**
+ * The state of the test callback.
+ */
+struct parser_test_context {
+  const char **expected;
+  int count;
+};
+
+/**
+ * Checks a decoded JSON object against the next expected encoding.
+ *
+ * @param void* context
+ *   The test state.
+ * @param struct json* object
+ *   The decoded JSON object.
+ *
+ * @return int
+ *   1 if the object matches the expected encoding, otherwise 0.
+ */
+static int on_json(void *context, struct json *object) {
+  struct parser_test_context *state = (struct parser_test_context *)context;
+  char *encoded = json_encode(object);
+  json_destroy(object);
+  const char *expected = state->expected[state->count++];
+  int matches = encoded != NULL && expected != NULL && strcmp(encoded, expected) == 0;
+  if (!matches) {
+    fprintf(stderr, "Parsed JSON '%s' does not match expected JSON '%s'.\n", encoded, expected);
+  }
+  free(encoded);
+  return matches;
+}
+
+/**
+ * Helper function to feed a JSON stream to a parser in chunks of the given size.
+ *
+ * @param const char *stream
+ *   The JSON stream.
+ * @param size_t chunk_size
+ *   The number of characters fed at once.
+ * @param const char **expected
+ *   The expected encoding of every JSON value of the stream.
+ * @param int count
+ *   The number of JSON values in the stream.
+ *
+ * @return int
+ *   EXIT_SUCCESS if every value was parsed as expected, otherwise EXIT_FAILURE.
+ */
+static int check_parser_stream(const char *stream, size_t chunk_size, const char **expected, int count) {
+  struct parser_test_context context = {expected, 0};
+  struct json_parser *parser = json_parser_create_tree(NULL, on_json, &context);
+  size_t length = strlen(stream);
+  int status = parser != NULL;
+  for (size_t offset = 0; status && offset < length; offset += chunk_size) {
+    // Feed a copy of the chunk, so that the parser cannot read past it.
+    size_t size = length - offset < chunk_size ? length - offset : chunk_size;
+    char *chunk = (char *)malloc(size);
+    memcpy(chunk, stream + offset, size);
+    status = json_parser_feed(parser, chunk, size);
+    free(chunk);
+  }
+  status = status && json_parser_finish(parser) && context.count == count;
+  json_parser_free(parser);
+  if (!status) {
+    fprintf(stderr, "Failed to parse the JSON stream in chunks of %zu characters.\n", chunk_size);
+    return EXIT_FAILURE;
+  }
+  printf("Parsed %d JSON values in chunks of %zu characters.\n", count, chunk_size);
+  return EXIT_SUCCESS;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int run_json_parser_unit_tests() {
+  // A stream of values ending with a number, which only completes at the end of the stream.
+  char large[1024] = "[";
+  for (int i = 0; i < 100; i++) {
+    strcat(large, i == 0 ? "\"item\"" : ",\"item\"");
+  }
+  strcat(large, "]");
+  char stream[2048];
+  snprintf(stream, sizeof(stream), "{\"name\" : \"John \\\"Doe\\\"\", \"age\": -30.5e1, \"ok\": [true, false, null]}\n%s\n\"text\" 12345", large);
+  const char *expected[] = {"{\"name\":\"John \\\"Doe\\\"\",\"age\":-305,\"ok\":[true,false,null]}", large, "\"text\"", "12345"};
+  size_t chunk_sizes[] = {1, 2, 3, 7, 100, 4096};
+  for (int i = 0; i < 6; i++) {
+    if (check_parser_stream(stream, chunk_sizes[i], expected, 4) == EXIT_FAILURE) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  // A long string cut off by many chunks, some of them ending on a backslash.
+  char text[2048] = "\"";
+  for (int i = 0; i < 200; i++) {
+    strcat(text, "ab\\\\\\\"");
+  }
+  strcat(text, "\"");
+  const char *texts[] = {text};
+  size_t text_chunk_sizes[] = {1, 3, 64};
+  for (int i = 0; i < 3; i++) {
+    if (check_parser_stream(text, text_chunk_sizes[i], texts, 1) == EXIT_FAILURE) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  // A stream ending inside a value is rejected.
+  struct parser_test_context context = {expected, 0};
+  struct json_parser *parser = json_parser_create_tree(NULL, on_json, &context);
+  if (parser == NULL || json_parser_feed(parser, "{\"name\":\"Jo", 11) == 0 || json_parser_finish(parser) == 1) {
+    fprintf(stderr, "Failed to reject a JSON stream ending inside a value.\n");
+    json_parser_free(parser);
+    return EXIT_FAILURE;
+  }
+  json_parser_free(parser);
+  printf("Rejected a JSON stream ending inside a value.\n");
+
+  return EXIT_SUCCESS;
+}
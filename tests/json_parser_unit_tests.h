@@ -0,0 +1,16 @@
+#ifndef JSON_PARSER_UNIT_TESTS_H
+#define JSON_PARSER_UNIT_TESTS_H
+
+/**
+ * Runs the JSON incremental parser unit tests.
+ *
+ * This function feeds a stream of JSON values to an incremental parser in chunks of
+ * various sizes, checks every decoded JSON object against the expected encoding, and
+ * checks that a stream ending inside a value is rejected.
+ *
+ * @return int
+ *   EXIT_SUCCESS if all tests pass, otherwise EXIT_FAILURE.
+ */
+int run_json_parser_unit_tests();
+
+#endif
@@ -0,0 +1,140 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/json.h"
+#include "json_sax_unit_tests.h"
+
+/**
+ * The state of the test callbacks.
+ */
+struct sax_test_context {
+  int depth;
+  int events;
+  int wanted;
+  char level[16];
+  double status;
+};
+
+/**
+ * Counts the container starts and tracks the nesting depth.
+ */
+static int on_start(void *context) {
+  struct sax_test_context *state = (struct sax_test_context *)context;
+  state->events++;
+  state->depth++;
+  return 1;
+}
+
+/**
+ * Counts the container ends and tracks the nesting depth.
+ */
+static int on_end(void *context) {
+  struct sax_test_context *state = (struct sax_test_context *)context;
+  state->events++;
+  state->depth--;
+  return 1;
+}
+
+/**
+ * Flags the top level keys whose value is wanted.
+ */
+static int on_key(void *context, const char *key, size_t length) {
+  struct sax_test_context *state = (struct sax_test_context *)context;
+  state->events++;
+  state->wanted = 0;
+  if (state->depth == 1 && length == 5 && strncmp(key, "level", length) == 0) {
+    state->wanted = 1;
+  } else if (state->depth == 1 && length == 6 && strncmp(key, "status", length) == 0) {
+    state->wanted = 2;
+  }
+  return 1;
+}
+
+/**
+ * Copies the wanted string value, resolving its escape sequences.
+ */
+static int on_string(void *context, const char *value, size_t length) {
+  struct sax_test_context *state = (struct sax_test_context *)context;
+  state->events++;
+  if (state->wanted == 1 && length < sizeof(state->level)) {
+    size_t written = 0;
+    json_sax_unescape(state->level, value, length, 0, &written);
+    state->level[written] = '\0';
+  }
+  return 1;
+}
+
+/**
+ * Copies the wanted number value.
+ */
+static int on_number(void *context, double value) {
+  struct sax_test_context *state = (struct sax_test_context *)context;
+  state->events++;
+  if (state->wanted == 2) {
+    state->status = value;
+  }
+  return 1;
+}
+
+/**
+ * Stops the parsing at the first boolean value.
+ */
+static int on_boolean(void *context, int value) {
+  struct sax_test_context *state = (struct sax_test_context *)context;
+  state->events++;
+  return 0;
+}
+
+/**
+ * {@inheritdoc}
+ */
+int run_json_sax_unit_tests() {
+  const char json_string[] = "{\"level\":\"error\",\"request\":{\"status\":200,\"tags\":[\"a\",null,{}]},\"status\":503} trailing";
+  struct json_sax_handler handler = {on_start, on_end, on_start, on_end, on_key, on_string, on_number, NULL, NULL};
+  struct sax_test_context context = {0, 0, 0, "", 0};
+
+  // Pick the top level 'level' and 'status' values.
+  size_t offset = 0;
+  if (json_sax_parse(json_string, strlen(json_string), &offset, NULL, &handler, &context) == 0) {
+    fprintf(stderr, "Failed to parse JSON events.\n");
+    return EXIT_FAILURE;
+  }
+  if (strcmp(context.level, "error") != 0 || context.status != 503 || context.depth != 0 || context.events != 17 || offset != strlen(json_string) - 9) {
+    fprintf(stderr, "Parsed JSON events do not match the expected values.\n");
+    return EXIT_FAILURE;
+  }
+  printf("Parsed %d JSON events: level '%s', status %g.\n", context.events, context.level, context.status);
+
+  // Stop the parsing from a callback.
+  handler.on_boolean = on_boolean;
+  memset(&context, 0, sizeof(context));
+  if (json_sax_parse("[1,true,2]", 10, &offset, NULL, &handler, &context) != 0 || context.events != 3 || offset != 6) {
+    fprintf(stderr, "Failed to stop the parsing from a callback.\n");
+    return EXIT_FAILURE;
+  }
+  printf("Parsing stopped by a callback at offset %zu.\n", offset);
+
+  // Resolve the escape sequences of the raw strings.
+  const char escaped[] = "{\"level\":\"a\\\"b\\u00e9\"}";
+  memset(&context, 0, sizeof(context));
+  if (json_sax_parse(escaped, strlen(escaped), NULL, NULL, &handler, &context) != 1 || strcmp(context.level, "a\"b\xc3\xa9") != 0) {
+    fprintf(stderr, "Unescaped JSON string '%s' does not match the expected value.\n", context.level);
+    return EXIT_FAILURE;
+  }
+  printf("Unescaped JSON string: %s\n", context.level);
+
+  // Reject invalid strings in strict mode.
+  const struct json_decode_options strict = {0, JSON_DECODE_STRICT};
+  const char *invalid[] = {"[\"\xff\xfe\"]", "[\"\\q\"]"};
+  handler.on_boolean = NULL;
+  for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+    memset(&context, 0, sizeof(context));
+    if (json_sax_parse(invalid[i], strlen(invalid[i]), NULL, &strict, &handler, &context) != 0 || json_sax_parse(invalid[i], strlen(invalid[i]), NULL, NULL, &handler, &context) != 1) {
+      fprintf(stderr, "Strict parsing accepted the invalid JSON string %s.\n", invalid[i]);
+      return EXIT_FAILURE;
+    }
+  }
+  printf("Strict parsing rejected %zu invalid strings.\n", sizeof(invalid) / sizeof(invalid[0]));
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,15 @@
+#ifndef JSON_SAX_UNIT_TESTS_H
+#define JSON_SAX_UNIT_TESTS_H
+
+/**
+ * Runs the JSON event based parser unit tests.
+ *
+ * This function parses a JSON string with callbacks that pick a few values out of it
+ * without building any JSON object, and checks that a callback can stop the parsing.
+ *
+ * @return int
+ *   EXIT_SUCCESS if all tests pass, otherwise EXIT_FAILURE.
+ */
+int run_json_sax_unit_tests();
+
+#endif
@@ -1,7 +1,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "json_decode_unit_tests.h"
+#include "json_document_unit_tests.h"
 #include "json_encode_unit_tests.h"
+#include "json_lines_unit_tests.h"
+#include "json_parser_unit_tests.h"
+#include "json_sax_unit_tests.h"
 
 /**
  * Main Unit Testing controller function.
@@ -25,6 +29,26 @@ int main(int argc, char const *argv[]) {
     // Unit tests failed.
     return EXIT_FAILURE;
   }
+  printf("\n------------------------------ Unit Test: json_document() ----------------------------\n");
+  if (run_json_document_unit_tests() == EXIT_FAILURE) {
+    // Unit tests failed.
+    return EXIT_FAILURE;
+  }
+  printf("\n------------------------------ Unit Test: json_sax_parse() ---------------------------\n");
+  if (run_json_sax_unit_tests() == EXIT_FAILURE) {
+    // Unit tests failed.
+    return EXIT_FAILURE;
+  }
+  printf("\n------------------------------ Unit Test: json_parser_feed() -------------------------\n");
+  if (run_json_parser_unit_tests() == EXIT_FAILURE) {
+    // Unit tests failed.
+    return EXIT_FAILURE;
+  }
+  printf("\n------------------------------ Unit Test: json_decode_lines() ------------------------\n");
+  if (run_json_lines_unit_tests() == EXIT_FAILURE) {
+    // Unit tests failed.
+    return EXIT_FAILURE;
+  }
   printf("\n");
   // Unit tests succeeded.
   return EXIT_SUCCESS;